@@ -12,26 +12,91 @@ Free to use, modify, or create your own fork, provided that you agree to and com
 #include <sstream>
 #include <filesystem>
 #include <map>
+#include <unordered_map>
 #include <chrono>
 #include <thread>
 #include <atomic>
 #include <mutex>
-#include <conio.h>
+#include <condition_variable>
+#include <functional>
+#include <memory>
 #include <algorithm>
 #include <vector>
 #include <future>
 #include <filesystem>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <cstdio>
+#include <cerrno>
+#include <new>
+
+#include "HexDecoder.h"
+
+// The tool is the library's first user and uses its names unqualified throughout
+using namespace hex2file;
 
 #ifdef _WIN32
 #include <windows.h>
+#include <psapi.h>
+#include <io.h>
+#include <fcntl.h>
+#include <conio.h>
 #else
 #include <unistd.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <termios.h>
+#include <csignal>
+#include <sys/mman.h>
+#include <sys/stat.h>
 #include <sys/statvfs.h>
+#include <sys/resource.h>
+#include <sys/uio.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#endif
+
+#if defined(__linux__) && defined(__has_include)
+#if __has_include(<linux/io_uring.h>)
+#define HEX2FILE_URING 1
+#include <sys/syscall.h>
+#include <linux/io_uring.h>
+#endif
 #endif
 
 const size_t CHUNK_SIZE_HEX = 2 * 1024 * 1024; // 2MB Chunk
 const size_t PROGRESS_BAR_WIDTH = 50;
 bool debug = false;
+unsigned int requestedThreads = 0; // 0 = use every hardware thread
+bool useMemoryMap = false;
+size_t memoryCap = 0; // bytes the streamed pipeline buffers may use, 0 = default chunk size
+size_t chunkSizeHex = 0; // streamed pipeline chunk from --chunkSize or the tuning profile, 0 = CHUNK_SIZE_HEX
+bool adaptiveChunks = false; // --adaptive: resize streamed chunks during the run from their measured latency
+bool useJournal = false; // checkpoint streamed conversions so they can be resumed
+bool resumeMode = false; // continue from the journal instead of starting over
+bool benchMode = false;
+bool selfTestMode = false;
+bool encodeMode = false; // raw file -> hex text instead of the other way round
+
+// Every heap allocation in the process goes through here, so --debug can prove the
+// steady-state conversion loop does not allocate
+std::atomic<size_t> heapAllocations{0};
+
+void* operator new(size_t size) {
+    heapAllocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+#if defined(__GNUC__) && !defined(__clang__) && __GNUC__ >= 11
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete" // GCC pairs the inlined free() with new, not malloc()
+#endif
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+#if defined(__GNUC__) && !defined(__clang__) && __GNUC__ >= 11
+#pragma GCC diagnostic pop
+#endif
 
 void debugPrint(const std::string& info) {
     if (debug) {
@@ -47,6 +112,45 @@ void printUsage() {
     std::cout << "  --outputFile / -o=<path>   Path to the output file where raw data will be written.\n";
     std::cout << "  --help / -h                Show this help message.\n";
     std::cout << "  --debug / -d               Enable debug mode for detailed output.\n";
+    std::cout << "  --threads / -t=<count>     Number of worker threads (default: all CPU cores).\n";
+    std::cout << "  --mmap / -m                Memory-map the input and output and decode all blocks in parallel.\n";
+    std::cout << "  --inputFormat=<format>     auto (default), hex, ihex (Intel HEX), srec (S-record), xxd or carray.\n";
+    std::cout << "  --fill=<hex bytes>         Fill gaps between records with this pattern (e.g. FF) instead of holes.\n";
+    std::cout << "  -i=- / -o=-                Read hex from standard input / write the output to standard output.\n";
+    std::cout << "  --maxMemory=<size>         Cap on pipeline buffer memory, e.g. 64M (default: about 18 MB).\n";
+    std::cout << "  --io=<stream|posix|uring>  File I/O of streamed conversions: iostreams (default), pread/pwrite or io_uring.\n";
+    std::cout << "  --direct                   Bypass the page cache with O_DIRECT (implies --io=uring when --io is not given).\n";
+    std::cout << "  --sparse                   Leave 4 KB blocks of zeros in the output as holes instead of writing them.\n";
+    std::cout << "  --incremental              Keep an index (<output>.h2findex) and only re-convert what changed next time.\n";
+    std::cout << "  --chunkSize=<size>         Input read per streamed pipeline chunk, e.g. 1M (default: tuning profile or 2M).\n";
+    std::cout << "  --adaptive                 Resize streamed chunks during the run from their measured latency.\n";
+    std::cout << "  --journal                  Keep a checkpoint journal (<output>.h2fjournal) so the run can be resumed.\n";
+    std::cout << "  --resume                   Check the output against its journal and continue where it stopped.\n";
+    std::cout << "  --stats=<json|prometheus>  Print per-stage timings, chunk latency histograms and thread utilization.\n";
+    std::cout << "  --statsOut=<path>          Write the --stats report to a file instead of the console.\n";
+    std::cout << "  --digest=<algorithm>       Checksum the output as it is written: crc32c, xxh3 or sha256.\n";
+    std::cout << "  --expect=<digest>          Fail unless the --digest matches; the output only appears once it does.\n";
+    std::cout << "\nBatch (many files on one shared set of worker threads):\n";
+    std::cout << "  -i=<path> -o=<path> ...    Repeat the --inputHex/--outputFile pair once per file.\n";
+    std::cout << "  --batch / -b=<manifest>    Read \"<input> <output>\" pairs from a text file, one per line.\n";
+    std::cout << "\nBenchmark (JSON Lines results, one object per measurement):\n";
+    std::cout << "  --bench                    Benchmark every decode kernel, I/O mode and thread count.\n";
+    std::cout << "  --benchSizes=<list>        Corpus sizes in decoded bytes (default: 1K,1M,64M).\n";
+    std::cout << "  --benchDir=<path>          Where the generated corpus is kept (default: temp directory).\n";
+    std::cout << "  --benchOut=<path>          Write results to a file instead of the console.\n";
+    std::cout << "  --selfTest                 Check that decoding undoes encoding for every kernel, layout and I/O mode.\n";
+    std::cout << "\nDaemon (Linux and other POSIX systems, jobs run on one warm set of worker threads):\n";
+    std::cout << "  --serve=<socket>           Serve conversion jobs on a Unix domain socket until stopped.\n";
+    std::cout << "  --client=<socket>          Send the -i/-o pairs or --batch manifest to a daemon and print its results.\n";
+    std::cout << "  --stop                     With --client: ask the daemon to finish its jobs and exit.\n";
+    std::cout << "\nTuning (the profile is loaded by every later run on this machine):\n";
+    std::cout << "  --tune                     Find the fastest decode kernel, thread count and chunk size and save them.\n";
+    std::cout << "  --profile=<path>           Profile to write or load (default: ~/.config/hex2file/profile).\n";
+    std::cout << "\nEncoding (raw file -> hex text, --inputHex names the raw file and --outputFile the hex file):\n";
+    std::cout << "  --encode / -e              Encode instead of decode.\n";
+    std::cout << "  --format=<spaced|dense>    Separate bytes with spaces like example/*.hex (default), or not at all.\n";
+    std::cout << "  --lowercase                Write a-f instead of A-F.\n";
+    std::cout << "  --lineBytes=<count>        Bytes per line (default: 0, everything on one line).\n";
 }
 
 void printVersion() {
@@ -99,9 +203,51 @@ std::string getAbsolutePath(const std::string& path) {
     return fsPath.is_absolute() ? path : std::filesystem::absolute(fsPath).string();
 }
 
-bool isHexChar(char c) {
-    return (c >= '0' && c <= '9') || (c >= 'A' && c <= 'F') || (c >= 'a' && c <= 'f');
+#ifndef _WIN32
+// conio.h stand-ins for the Tab + ESC check. The terminal is switched to unbuffered, unechoed input on first
+// use and restored at exit (or on SIGINT/SIGTERM). With no terminal on stdin no key is ever reported.
+bool keyboardPolling = true; // off while stdin carries the input (-i=-)
+termios savedTerminal;
+std::atomic<bool> terminalChanged{false};
+
+void restoreTerminal() {
+    if (terminalChanged.exchange(false)) tcsetattr(STDIN_FILENO, TCSANOW, &savedTerminal);
+}
+
+void restoreTerminalOnSignal(int signal) {
+    restoreTerminal();
+    std::signal(signal, SIG_DFL);
+    std::raise(signal);
+}
+
+bool keyboardReady() {
+    static const bool ready = [] {
+        if (!isatty(STDIN_FILENO) || tcgetattr(STDIN_FILENO, &savedTerminal) != 0) return false;
+        termios raw = savedTerminal;
+        raw.c_lflag &= ~static_cast<tcflag_t>(ICANON | ECHO);
+        raw.c_cc[VMIN] = 0;
+        raw.c_cc[VTIME] = 0;
+        if (tcsetattr(STDIN_FILENO, TCSANOW, &raw) != 0) return false;
+        terminalChanged = true;
+        std::atexit(restoreTerminal);
+        std::signal(SIGINT, restoreTerminalOnSignal);
+        std::signal(SIGTERM, restoreTerminalOnSignal);
+        return true;
+    }();
+    return ready;
+}
+
+int _kbhit() {
+    if (!keyboardPolling || !keyboardReady()) return 0;
+    pollfd key = { STDIN_FILENO, POLLIN, 0 };
+    return poll(&key, 1, 0) > 0 && (key.revents & POLLIN) != 0;
+}
+
+int _getch() {
+    unsigned char c;
+    return ::read(STDIN_FILENO, &c, 1) == 1 ? c : -1;
 }
+#endif
 
 // Function to handle the Tab + ESC key combination to exit
 bool checkTabEscExit() {
@@ -129,361 +275,5537 @@ bool checkTabEscExit() {
     return false;
 }
 
-// Convert a hex chunk to a byte vector using multi-core/threading
-void hexStringToBytesParallel(const std::string& hex, std::vector<char>& out, unsigned int numThreads) {
-    size_t hexLen = hex.size();
-    size_t numBytes = hexLen / 2;
-    out.resize(numBytes);
+// Picked once at startup from the CPUID feature bits
+DecodeKernel decodeKernel = { "scalar", decodeHexScalar };
 
-    std::vector<std::thread> threads;
-    auto convert = [&](size_t start, size_t end) {
-        for (size_t i = start; i < end; ++i) {
-            std::string byteString = hex.substr(i * 2, 2);
-            out[i] = static_cast<char>(std::stoi(byteString, nullptr, 16));
-        }
-    };
-    size_t chunkPerThread = numBytes / numThreads;
-    size_t leftover = numBytes % numThreads;
+// Layout of the --encode output
+struct EncodeFormat {
+    bool uppercase = true;
+    bool spaced = true;   // "4C 6F 72" like example/*.hex, otherwise dense "4C6F72"
+    size_t lineBytes = 0; // bytes per line, 0 keeps everything on one line
+};
 
-    size_t begin = 0;
-    for (unsigned int t = 0; t < numThreads; ++t) {
-        size_t end = begin + chunkPerThread + ((t < leftover) ? 1 : 0);
-        threads.emplace_back(convert, begin, end);
-        begin = end;
+const char HEX_DIGITS_UPPER[] = "0123456789ABCDEF";
+const char HEX_DIGITS_LOWER[] = "0123456789abcdef";
+
+// Encode kernels write two digits per byte, each followed by a ' ' when 'spaced'
+void encodeHexScalar(const unsigned char* in, size_t n, char* out, const char* digits, bool spaced) {
+    size_t step = spaced ? 3 : 2;
+    for (size_t i = 0; i < n; ++i, out += step) {
+        out[0] = digits[in[i] >> 4];
+        out[1] = digits[in[i] & 0x0F];
+        if (spaced) out[2] = ' ';
     }
-    for (auto& th : threads) th.join();
 }
 
-bool processFile(const std::string& inputPath, const std::string& outputPath) {
-    debugPrint("Checking if input file exists: " + inputPath);
-    if (!std::filesystem::exists(inputPath)) {
-        std::cerr << "[ERROR]: Hex file not found! (" << inputPath << ")" << std::endl;
-        return false;
+#ifdef HEX2FILE_X86
+// pshufb masks spreading 16 digit pairs over 48 "HL " triples; 0x80 lanes are zeroed and filled with a space
+struct SpacedShuffle {
+    unsigned char mask[3][16];
+    unsigned char space[3][16];
+    constexpr SpacedShuffle() : mask(), space() {
+        const int base[3] = { 0, 8, 16 }; // first digit held by the source register of each output register
+        for (int r = 0; r < 3; ++r) {
+            for (int j = 0; j < 16; ++j) {
+                int o = 16 * r + j, pos = o % 3;
+                mask[r][j] = (pos == 2) ? 0x80 : static_cast<unsigned char>(2 * (o / 3) + pos - base[r]);
+                space[r][j] = (pos == 2) ? ' ' : 0;
+            }
+        }
     }
+};
+constexpr SpacedShuffle SPACED_SHUFFLE;
 
-    std::ifstream input(inputPath);
-    if (!input.is_open()) {
-        std::cerr << "[ERROR]: Unable to open input hex file!" << std::endl;
-        return false;
+// Turn 16 bytes into 32 digits: d0 holds the digits of bytes 0-7, d1 those of bytes 8-15
+__attribute__((target("ssse3"), always_inline))
+inline void hexDigitsSSSE3(__m128i x, __m128i lut, __m128i& d0, __m128i& d1) {
+    __m128i nibble = _mm_set1_epi8(0x0F);
+    __m128i hi = _mm_shuffle_epi8(lut, _mm_and_si128(_mm_srli_epi16(x, 4), nibble));
+    __m128i lo = _mm_shuffle_epi8(lut, _mm_and_si128(x, nibble));
+    d0 = _mm_unpacklo_epi8(hi, lo);
+    d1 = _mm_unpackhi_epi8(hi, lo);
+}
+
+__attribute__((target("ssse3"), always_inline))
+inline void storeSpacedSSSE3(__m128i d0, __m128i d1, char* out) {
+    __m128i source[3] = { d0, _mm_alignr_epi8(d1, d0, 8), d1 };
+    for (int r = 0; r < 3; ++r) {
+        __m128i mask = _mm_loadu_si128(reinterpret_cast<const __m128i*>(SPACED_SHUFFLE.mask[r]));
+        __m128i space = _mm_loadu_si128(reinterpret_cast<const __m128i*>(SPACED_SHUFFLE.space[r]));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 16 * r), _mm_or_si128(_mm_shuffle_epi8(source[r], mask), space));
     }
-    debugPrint("Input hex file opened: " + inputPath);
+}
 
-    std::ofstream output(outputPath, std::ios::binary);
-    if (!output.is_open()) {
-        std::cerr << "[ERROR]: Unable to open output file!" << std::endl;
-        return false;
+__attribute__((target("ssse3")))
+void encodeHexSSSE3(const unsigned char* in, size_t n, char* out, const char* digits, bool spaced) {
+    __m128i lut = _mm_loadu_si128(reinterpret_cast<const __m128i*>(digits));
+    size_t step = spaced ? 3 : 2;
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) { // 16 bytes -> 32 digits
+        __m128i d0, d1;
+        hexDigitsSSSE3(_mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i)), lut, d0, d1);
+        if (spaced) {
+            storeSpacedSSSE3(d0, d1, out + 3 * i);
+        } else {
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 2 * i), d0);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 2 * i + 16), d1);
+        }
     }
-    debugPrint("Output file opened: " + outputPath);
-    
-    // Debug storage info
-    try {
-        std::filesystem::space_info space = std::filesystem::space(outputPath);
-
-        double available = static_cast<double>(space.available);
-        double free = static_cast<double>(space.free);
-        double capacity = static_cast<double>(space.capacity);
-
-        std::ostringstream stream;
-        stream << std::fixed << std::setprecision(2);
-
-        // Print available, free, and total capacity disk space
-        if (available >= 1024.0 * 1024.0 * 1024.0) {
-            stream << "Disk space available: " 
-                << (available / (1024.0 * 1024.0 * 1024.0)) << " GB\n"
-                << "[DEBUG]: Disk space free: " 
-                << (free / (1024.0 * 1024.0 * 1024.0)) << " GB\n"
-                << "[DEBUG]: Disk space capacity: " 
-                << (capacity / (1024.0 * 1024.0 * 1024.0)) << " GB";
+    encodeHexScalar(in + i, n - i, out + step * i, digits, spaced);
+}
+
+__attribute__((target("avx2")))
+void encodeHexAVX2(const unsigned char* in, size_t n, char* out, const char* digits, bool spaced) {
+    __m256i lut = _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(digits)));
+    __m256i nibble = _mm256_set1_epi8(0x0F);
+    size_t step = spaced ? 3 : 2;
+    size_t i = 0;
+    for (; i + 32 <= n; i += 32) { // 32 bytes -> 64 digits
+        __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + i));
+        __m256i hi = _mm256_shuffle_epi8(lut, _mm256_and_si256(_mm256_srli_epi16(x, 4), nibble));
+        __m256i lo = _mm256_shuffle_epi8(lut, _mm256_and_si256(x, nibble));
+        __m256i a = _mm256_unpacklo_epi8(hi, lo); // bytes 0-7 | 16-23
+        __m256i b = _mm256_unpackhi_epi8(hi, lo); // bytes 8-15 | 24-31
+        if (spaced) {
+            storeSpacedSSSE3(_mm256_castsi256_si128(a), _mm256_castsi256_si128(b), out + 3 * i);
+            storeSpacedSSSE3(_mm256_extracti128_si256(a, 1), _mm256_extracti128_si256(b, 1), out + 3 * i + 48);
         } else {
-            stream << "Disk space available: " 
-                << (available / (1024.0 * 1024.0)) << " MB\n"
-                << "[DEBUG]: Disk space free: " 
-                << (free / (1024.0 * 1024.0)) << " MB\n"
-                << "[DEBUG]: Disk space capacity: " 
-                << (capacity / (1024.0 * 1024.0 * 1024.0)) << " GB";
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + 2 * i), _mm256_permute2x128_si256(a, b, 0x20));
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + 2 * i + 32), _mm256_permute2x128_si256(a, b, 0x31));
         }
-        debugPrint(stream.str());
-    } catch (const std::exception& e) {
-        debugPrint(std::string("Failed to get disk space info: ") + e.what());
     }
+    encodeHexScalar(in + i, n - i, out + step * i, digits, spaced);
+}
+#endif
 
-    std::cout << "Starting to Convert file..." << std::endl;
-    std::cout << "Press Tab + ESC to exit when you're tired enough.\n" << std::endl;
+struct EncodeKernel {
+    const char* name;
+    void (*encode)(const unsigned char* in, size_t n, char* out, const char* digits, bool spaced);
+};
 
-    // Display Total Number of CPU Cores
-    unsigned int numCores = std::thread::hardware_concurrency();
-    if (numCores < 1) numCores = 2;
-    std::cout << "Total Number of CPU Cores: " << numCores << std::endl;
+// Every encode kernel this CPU can run, slowest first
+std::vector<EncodeKernel> availableEncodeKernels() {
+    std::vector<EncodeKernel> kernels = { { "scalar", encodeHexScalar } };
+#ifdef HEX2FILE_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("ssse3")) kernels.push_back({ "ssse3", encodeHexSSSE3 });
+    if (__builtin_cpu_supports("avx2")) kernels.push_back({ "avx2", encodeHexAVX2 });
+#endif
+    return kernels;
+}
 
-    std::string line, hexBuffer;
-    auto startTime = std::chrono::steady_clock::now();
-    size_t writtenBytes = 0;
-    long lastPrintedElapsed = -1; // NEW
-    double lastBytesPerSec = 0.0; // NEW: for showing transfer rate
-
-    while (std::getline(input, line)) {
-        //debugPrint("Reading line: " + line);
-        line.erase(std::remove_if(line.begin(), line.end(), ::isspace), line.end());
-        //debugPrint("Line after removing whitespace: " + line);
-
-        for (char c : line) {
-            if (!isHexChar(c)) {
-                std::cerr << "[ERROR]: Not a valid hex file!" << std::endl;
-                debugPrint("Invalid hex character detected: " + std::string(1, c));
-                return false;
-            }
+EncodeKernel encodeKernel = { "scalar", encodeHexScalar };
+EncodeFormat encodeFormat;
+
+// Characters that bytes [firstIndex, firstIndex + n) of the input encode to; 'atEnd' when they close the input
+size_t encodedLength(const EncodeFormat& format, size_t firstIndex, size_t n, bool atEnd) {
+    size_t lineBytes = format.lineBytes;
+    if (format.spaced) return 3 * n - ((lineBytes == 0 && atEnd && n > 0) ? 1 : 0);
+    size_t length = 2 * n;
+    if (lineBytes > 0) {
+        length += (firstIndex + n) / lineBytes - firstIndex / lineBytes;
+        if (atEnd && n > 0 && (firstIndex + n) % lineBytes != 0) length++;
+    }
+    return length;
+}
+
+// Encode bytes [firstIndex, firstIndex + n) of the input, separators and line breaks included.
+// Every byte's layout follows from its absolute position, so any split of the input encodes identically.
+size_t encodeRange(const EncodeFormat& format, const unsigned char* in, size_t firstIndex, size_t n, bool atEnd, char* out) {
+    const char* digits = format.uppercase ? HEX_DIGITS_UPPER : HEX_DIGITS_LOWER;
+    size_t lineBytes = format.lineBytes;
+    size_t step = format.spaced ? 3 : 2;
+    char* p = out;
+    size_t i = 0;
+    while (i < n) {
+        size_t run = n - i;
+        if (lineBytes > 0) run = std::min(run, lineBytes - (firstIndex + i) % lineBytes);
+        encodeKernel.encode(in + i, run, p, digits, format.spaced);
+        p += step * run;
+        i += run;
+
+        bool lineEnd = lineBytes > 0 && ((firstIndex + i) % lineBytes == 0 || (atEnd && i == n));
+        if (format.spaced) {
+            if (lineEnd) p[-1] = '\n';
+            else if (atEnd && i == n) p--; // no separator after the very last byte
+        } else if (lineEnd) {
+            *p++ = '\n';
         }
+    }
+    return static_cast<size_t>(p - out);
+}
+
+// What goes in front of a block encoded on its own when the input is streamed block by block. A spaced block
+// leaves out the separator after its last byte and the next block starts with it, since only the next block
+// knows whether that byte closed the input ('atEnd': the empty block that ends a stream). Dense text only
+// needs the line break after a short last line.
+size_t blockLead(const EncodeFormat& format, size_t firstIndex, bool atEnd, char* out) {
+    if (firstIndex == 0) return 0;
+    bool lineEnd = format.lineBytes > 0 && (atEnd || firstIndex % format.lineBytes == 0);
+    if (format.spaced ? (lineEnd || !atEnd) : (lineEnd && atEnd && firstIndex % format.lineBytes != 0)) {
+        *out = lineEnd ? '\n' : ' ';
+        return 1;
+    }
+    return 0;
+}
 
-        hexBuffer += line;
-        debugPrint("Hex buffer size after append: " + std::to_string(hexBuffer.size()));
+// Circular buffer over a single allocation, usable as a FIFO (pop_front) or LIFO (pop_back).
+// It only reallocates if pushed past its capacity, so a correctly sized ring never touches the heap again.
+template <typename T>
+class RingBuffer {
+public:
+    explicit RingBuffer(size_t capacity) : slots(std::max<size_t>(capacity, 1)) {}
 
-        // Multi-core optimized chunk processing
-        while (hexBuffer.size() >= CHUNK_SIZE_HEX) {
-            std::string chunkHex = hexBuffer.substr(0, CHUNK_SIZE_HEX);
-            hexBuffer.erase(0, CHUNK_SIZE_HEX);
+    bool empty() const { return count == 0; }
+    size_t size() const { return count; }
 
-            std::vector<char> chunkBytes;
-            hexStringToBytesParallel(chunkHex, chunkBytes, numCores);
-            output.write(chunkBytes.data(), chunkBytes.size());
-            writtenBytes += chunkBytes.size();
+    void push_back(T item) {
+        if (count == slots.size()) grow();
+        slots[(head + count) % slots.size()] = std::move(item);
+        count++;
+    }
 
-            if (!output) {
-                std::cerr << "[ERROR]: Unable to write data in your disk. It may be full or corrupted.\n" << std::endl;
-                return false;
-            }
-            // Check if Tab + ESC is pressed to exit
-            if (checkTabEscExit()) {
-                std::cout << "\nExiting conversion as requested by user (Tab + ESC).\n" << std::endl;
-                return false;
-            }
+    T pop_front() {
+        T item = std::move(slots[head]);
+        head = (head + 1) % slots.size();
+        count--;
+        return item;
+    }
 
-            // LIVE TIMER DISPLAY - NEW
-            auto currentTime = std::chrono::steady_clock::now();
-            auto elapsed = std::chrono::duration_cast<std::chrono::seconds>(currentTime - startTime).count();
-            if (elapsed != lastPrintedElapsed) {
-                lastPrintedElapsed = elapsed;
+    T pop_back() {
+        count--;
+        return std::move(slots[(head + count) % slots.size()]);
+    }
 
-                size_t totalEstimatedBytes = writtenBytes + hexBuffer.size() / 2;
-                double bytesPerSec = (elapsed > 0) ? static_cast<double>(writtenBytes) / elapsed : 0.0;
-                size_t estRemainSecs = (bytesPerSec > 0) ? static_cast<size_t>((totalEstimatedBytes - writtenBytes) / bytesPerSec) : 0;
+private:
+    std::vector<T> slots;
+    size_t head = 0, count = 0;
 
-                int hrs = static_cast<int>(elapsed / 3600);
-                int mins = static_cast<int>((elapsed % 3600) / 60);
-                int secs = static_cast<int>(elapsed % 60);
+    void grow() {
+        std::vector<T> bigger(slots.size() * 2);
+        for (size_t i = 0; i < count; ++i) bigger[i] = std::move(slots[(head + i) % slots.size()]);
+        slots.swap(bigger);
+        head = 0;
+    }
+};
 
-                std::ostringstream timerInfo;
-                timerInfo << "Conversion Progress Status: [Elapsed: "
-                        << std::setw(2) << std::setfill('0') << hrs << ":"
-                        << std::setw(2) << std::setfill('0') << mins << ":"
-                        << std::setw(2) << std::setfill('0') << secs << " | ";
+// Stage telemetry for --stats. Each thread owns a cache-line aligned slot and only ever adds to
+// its own counters, so recording is a couple of uncontended relaxed atomics per chunk and
+// nothing at all (not even a clock read) while --stats is off.
+enum class Stage { Read, Sanitize, Validate, Decode, Encode, Write, Digest, Count };
+const size_t STAGE_COUNT = static_cast<size_t>(Stage::Count);
+const char* const STAGE_NAMES[STAGE_COUNT] = { "read", "sanitize", "validate", "decode", "encode", "write", "digest" };
 
-                // Calculate remaining time if any
-                if (estRemainSecs > 0) {
-                    int rhrs = static_cast<int>(estRemainSecs / 3600);
-                    int rmins = static_cast<int>((estRemainSecs % 3600) / 60);
-                    int rsecs = static_cast<int>(estRemainSecs % 60);
+const size_t STATS_SLOTS = 128;
+const size_t STATS_BUCKETS = 40; // chunk latency buckets: bucket b holds durations below 2^b ns
 
-                    timerInfo << "Remaining: " << rhrs << "h " << rmins << "m " << rsecs << "s";
-                } else {
-                    timerInfo << "Remaining: 00h 00m 00s";
-                }
+enum class StatsFormat { Off, Json, Prometheus };
+StatsFormat statsFormat = StatsFormat::Off;
+std::string statsOutputPath; // stdout when empty
 
-                // Show speed
-                timerInfo << " | Speed Rate: ";
-                if (bytesPerSec >= 1024.0 * 1024.0 * 1024.0) {
-                    timerInfo << std::fixed << std::setprecision(2)
-                            << (bytesPerSec / (1024.0 * 1024.0 * 1024.0)) << " GB/s]";
-                } else if (bytesPerSec >= 1024.0 * 1024.0) {
-                    timerInfo << std::fixed << std::setprecision(2)
-                            << (bytesPerSec / (1024.0 * 1024.0)) << " MB/s]";
-                } else if (bytesPerSec >= 1024.0) {
-                    timerInfo << std::fixed << std::setprecision(2)
-                            << (bytesPerSec / 1024.0) << " KB/s]";
-                } else {
-                    timerInfo << std::fixed << std::setprecision(2)
-                            << bytesPerSec << " B/s";
-                }
+struct alignas(64) StatsSlot {
+    std::atomic<const char*> role;
+    std::atomic<uint64_t> ns[STAGE_COUNT];
+    std::atomic<uint64_t> chunks[STAGE_COUNT];
+    std::atomic<uint64_t> bytes[STAGE_COUNT];
+    std::atomic<uint64_t> histogram[STAGE_COUNT][STATS_BUCKETS];
+};
+StatsSlot statsSlots[STATS_SLOTS];
+std::atomic<size_t> statsSlotsUsed{0};
 
-                // Ensure output fits fixed width (if you want the text output to stay within the terminal width)
-                std::string outStr = timerInfo.str();
-                outStr.resize(120, ' '); // Adjust width as needed (120 chars here for example)
-    
-                // Print the progress in the same line (overwrites previous)
-                std::cout << "\r" << outStr << std::flush;
-            }
-            // debugPrint still runs at 512 KB
-            if (writtenBytes % (512 * 1024) == 0) {
-                printProgress(writtenBytes, writtenBytes + hexBuffer.size() / 2);
-				debugPrint("\nWritten bytes so far: " + std::to_string(writtenBytes));                
-            }
-        }
-    }
+uint64_t statsClock() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
 
-    // Final chunk (if any)
-    if (!hexBuffer.empty()) {
-        if (hexBuffer.size() % 2 != 0) {
-            std::cerr << "[ERROR]: Odd number of hex characters!" << std::endl;
-            debugPrint("Hex buffer leftover: " + hexBuffer);
-            return false;
-        }
-        std::vector<char> chunkBytes;
-        hexStringToBytesParallel(hexBuffer, chunkBytes, numCores);
-        output.write(chunkBytes.data(), chunkBytes.size());
-        writtenBytes += chunkBytes.size();
+StatsSlot& threadStatsSlot() {
+    thread_local StatsSlot* slot = &statsSlots[statsSlotsUsed++ % STATS_SLOTS];
+    return *slot;
+}
+
+// Names the calling thread in the per-thread part of the report
+void setStatsRole(const char* role) {
+    if (statsFormat != StatsFormat::Off) threadStatsSlot().role = role;
+}
+
+void recordStage(Stage stage, uint64_t ns, size_t bytes) {
+    StatsSlot& slot = threadStatsSlot();
+    size_t s = static_cast<size_t>(stage);
+    size_t bucket = 0;
+    while (bucket + 1 < STATS_BUCKETS && (ns >> bucket) != 0) ++bucket;
+    slot.ns[s].fetch_add(ns, std::memory_order_relaxed);
+    slot.chunks[s].fetch_add(1, std::memory_order_relaxed);
+    slot.bytes[s].fetch_add(bytes, std::memory_order_relaxed);
+    slot.histogram[s][bucket].fetch_add(1, std::memory_order_relaxed);
+}
+
+// Times one chunk of a stage from construction to destruction
+class StageTimer {
+public:
+    StageTimer(Stage stage, size_t bytes) : stage(stage), bytes(bytes), start(statsFormat != StatsFormat::Off ? statsClock() : 0) {}
+    ~StageTimer() { stop(); }
+
+    void setBytes(size_t count) { bytes = count; }
+
+    void stop() {
+        if (start == 0) return;
+        recordStage(stage, statsClock() - start, bytes);
+        start = 0;
     }
 
-    printProgress(writtenBytes, writtenBytes);
-    std::cout << std::endl;
+    // Closes the current chunk and starts timing the next one
+    void restart(size_t nextBytes) {
+        stop();
+        bytes = nextBytes;
+        start = statsFormat != StatsFormat::Off ? statsClock() : 0;
+    }
 
-    // FINAL TIME REPORT - NEW
-    auto endTime = std::chrono::steady_clock::now();
-    auto totalElapsed = std::chrono::duration_cast<std::chrono::seconds>(endTime - startTime).count();
+private:
+    Stage stage;
+    size_t bytes;
+    uint64_t start;
+};
 
-    int thrs = static_cast<int>(totalElapsed / 3600);
-    int tmins = static_cast<int>((totalElapsed % 3600) / 60);
-    int tsecs = static_cast<int>(totalElapsed % 60);
+std::string jsonString(const std::string& text) {
+    std::string quoted = "\"";
+    for (char c : text) {
+        if (c == '"' || c == '\\') {
+            quoted += '\\';
+            quoted += c;
+        } else if (static_cast<unsigned char>(c) < 0x20) {
+            char escaped[8];
+            std::snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+            quoted += escaped;
+        } else {
+            quoted += c;
+        }
+    }
+    return quoted + "\"";
+}
 
-    std::cout << "Conversion Elapsed: "
-            << std::setw(2) << std::setfill('0') << thrs << ":"
-            << std::setw(2) << std::setfill('0') << tmins << ":"
-            << std::setw(2) << std::setfill('0') << tsecs << std::endl;
+// Writes the --stats report for a run of 'wallNs' that read 'inputBytes' and wrote 'outputBytes'
+bool writeStatsReport(uint64_t wallNs, size_t inputBytes, size_t outputBytes) {
+    if (statsFormat == StatsFormat::Off) return true;
+    std::ofstream file;
+    if (!statsOutputPath.empty()) {
+        file.open(statsOutputPath);
+        if (!file.is_open()) {
+            std::cerr << "[ERROR]: Unable to open stats output file! (" << statsOutputPath << ")" << std::endl;
+            return false;
+        }
+    }
+    std::ostream& out = statsOutputPath.empty() ? std::cout : file;
 
-    double totalBytesPerSec = (totalElapsed > 0) ? static_cast<double>(writtenBytes) / totalElapsed : 0.0;
+    // Stage totals over every thread
+    uint64_t ns[STAGE_COUNT] = {}, chunks[STAGE_COUNT] = {}, bytes[STAGE_COUNT] = {};
+    uint64_t histogram[STAGE_COUNT][STATS_BUCKETS] = {};
+    size_t usedSlots = std::min(statsSlotsUsed.load(), STATS_SLOTS);
+    for (size_t t = 0; t < usedSlots; ++t) {
+        for (size_t s = 0; s < STAGE_COUNT; ++s) {
+            ns[s] += statsSlots[t].ns[s];
+            chunks[s] += statsSlots[t].chunks[s];
+            bytes[s] += statsSlots[t].bytes[s];
+            for (size_t b = 0; b < STATS_BUCKETS; ++b) histogram[s][b] += statsSlots[t].histogram[s][b];
+        }
+    }
+    auto threadBusy = [&](size_t t) {
+        uint64_t busy = 0;
+        for (size_t s = 0; s < STAGE_COUNT; ++s) busy += statsSlots[t].ns[s];
+        return busy;
+    };
+    auto threadRole = [&](size_t t) {
+        const char* role = statsSlots[t].role;
+        return std::string(role ? role : "main");
+    };
 
-    // Show Data Transfer rate speed
-    std::cout << "Data Transfer rate speed: ";
-    if (totalBytesPerSec >= 1024.0 * 1024.0 * 1024.0) {
-        std::cout << std::fixed << std::setprecision(2)
-                << (totalBytesPerSec / (1024.0 * 1024.0 * 1024.0)) << " GB/s" << std::endl;
-    } else if (totalBytesPerSec >= 1024.0 * 1024.0) {
-        std::cout << std::fixed << std::setprecision(2)
-                << (totalBytesPerSec / (1024.0 * 1024.0)) << " MB/s" << std::endl;
-    } else if (totalBytesPerSec >= 1024.0) {
-        std::cout << std::fixed << std::setprecision(2)
-                << (totalBytesPerSec / 1024.0) << " KB/s" << std::endl;
+    out << std::defaultfloat << std::setprecision(9);
+    if (statsFormat == StatsFormat::Json) {
+        out << "{\"wallNs\":" << wallNs << ",\"inputBytes\":" << inputBytes << ",\"outputBytes\":" << outputBytes << ",\"stages\":{";
+        for (size_t s = 0; s < STAGE_COUNT; ++s) {
+            out << (s ? "," : "") << "\"" << STAGE_NAMES[s] << "\":{\"ns\":" << ns[s] << ",\"chunks\":" << chunks[s]
+                << ",\"bytes\":" << bytes[s] << ",\"histogram\":[";
+            bool first = true;
+            for (size_t b = 0; b < STATS_BUCKETS; ++b) {
+                if (histogram[s][b] == 0) continue;
+                out << (first ? "" : ",") << "{\"ltNs\":" << (1ull << b) << ",\"count\":" << histogram[s][b] << "}";
+                first = false;
+            }
+            out << "]}";
+        }
+        out << "},\"threads\":[";
+        for (size_t t = 0; t < usedSlots; ++t) {
+            uint64_t busy = threadBusy(t);
+            out << (t ? "," : "") << "{\"id\":" << t << ",\"role\":" << jsonString(threadRole(t)) << ",\"busyNs\":" << busy
+                << ",\"utilization\":" << (wallNs > 0 ? static_cast<double>(busy) / wallNs : 0.0) << "}";
+        }
+        out << "]}" << std::endl;
     } else {
-        std::cout << std::fixed << std::setprecision(2)
-                << totalBytesPerSec << " B/s" << std::endl;
+        out << "# TYPE hex2file_wall_seconds gauge\nhex2file_wall_seconds " << wallNs / 1e9 << "\n";
+        out << "# TYPE hex2file_input_bytes_total counter\nhex2file_input_bytes_total " << inputBytes << "\n";
+        out << "# TYPE hex2file_output_bytes_total counter\nhex2file_output_bytes_total " << outputBytes << "\n";
+        out << "# TYPE hex2file_stage_seconds_total counter\n";
+        for (size_t s = 0; s < STAGE_COUNT; ++s) out << "hex2file_stage_seconds_total{stage=\"" << STAGE_NAMES[s] << "\"} " << ns[s] / 1e9 << "\n";
+        out << "# TYPE hex2file_stage_bytes_total counter\n";
+        for (size_t s = 0; s < STAGE_COUNT; ++s) out << "hex2file_stage_bytes_total{stage=\"" << STAGE_NAMES[s] << "\"} " << bytes[s] << "\n";
+        out << "# TYPE hex2file_chunk_seconds histogram\n";
+        for (size_t s = 0; s < STAGE_COUNT; ++s) {
+            uint64_t cumulative = 0;
+            for (size_t b = 0; b < STATS_BUCKETS && chunks[s] > 0; ++b) {
+                cumulative += histogram[s][b];
+                if (histogram[s][b] == 0 && cumulative != chunks[s]) continue;
+                out << "hex2file_chunk_seconds_bucket{stage=\"" << STAGE_NAMES[s] << "\",le=\"" << (1ull << b) / 1e9 << "\"} " << cumulative << "\n";
+                if (cumulative == chunks[s]) break;
+            }
+            out << "hex2file_chunk_seconds_bucket{stage=\"" << STAGE_NAMES[s] << "\",le=\"+Inf\"} " << chunks[s] << "\n";
+            out << "hex2file_chunk_seconds_sum{stage=\"" << STAGE_NAMES[s] << "\"} " << ns[s] / 1e9 << "\n";
+            out << "hex2file_chunk_seconds_count{stage=\"" << STAGE_NAMES[s] << "\"} " << chunks[s] << "\n";
+        }
+        out << "# TYPE hex2file_thread_busy_seconds_total counter\n";
+        for (size_t t = 0; t < usedSlots; ++t) {
+            out << "hex2file_thread_busy_seconds_total{thread=\"" << t << "\",role=\"" << threadRole(t) << "\"} " << threadBusy(t) / 1e9 << "\n";
+        }
+        out << "# TYPE hex2file_thread_utilization gauge\n";
+        for (size_t t = 0; t < usedSlots; ++t) {
+            out << "hex2file_thread_utilization{thread=\"" << t << "\",role=\"" << threadRole(t) << "\"} "
+                << (wallNs > 0 ? static_cast<double>(threadBusy(t)) / wallNs : 0.0) << "\n";
+        }
+        out.flush();
     }
-    std::cout << "Conversion successful! Output written to " << outputPath << std::endl;
-    debugPrint("Final written byte count: " + std::to_string(writtenBytes));
-    return true;
+    return static_cast<bool>(out);
 }
 
-int main(int argc, char* argv[]) {
-    std::map<std::string, std::string> args;
+// Tasks submitted together; ThreadPool::wait() blocks until all of them finished
+class TaskGroup {
+    friend class ThreadPool;
+    std::atomic<size_t> pending{0};
+    std::mutex lock;
+    std::condition_variable done;
+};
 
-    if (argc < 2) {
-        printIntroMessage();
-        return 0;
+// Long-lived worker threads, each with its own task deque.
+// Owners pop from the back of their deque, idle workers steal from the front of others.
+// Whole-file jobs sit in a separate FIFO that only idle workers take from, never a waiting thread,
+// so a job waiting on its own tasks cannot end up running another job underneath it.
+class ThreadPool {
+public:
+    explicit ThreadPool(unsigned int numThreads) {
+        if (numThreads < 1) numThreads = 1;
+        for (unsigned int i = 0; i < numThreads; ++i) queues.emplace_back(new WorkQueue);
+        for (unsigned int i = 0; i < numThreads; ++i) threads.emplace_back(&ThreadPool::workerLoop, this, i);
     }
 
-    bool inputHexFlagFound = false;
-    bool outputFileFlagFound = false;
-    bool inputHexBeforeOutput = false;
+    ~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> guard(sleepLock);
+            stopping = true;
+        }
+        wake.notify_all();
+        for (auto& th : threads) th.join();
+    }
 
-    for (int i = 1; i < argc; ++i) {
-        std::string arg = argv[i];
-        debugPrint("Parsing argument: " + arg);
+    unsigned int size() const { return static_cast<unsigned int>(threads.size()); }
 
-        std::string lowerArg = arg;
-        std::transform(lowerArg.begin(), lowerArg.end(), lowerArg.begin(), ::tolower);
+    void submit(TaskGroup& group, std::function<void()> fn) {
+        group.pending++;
+        // Workers keep their own tasks local, outside callers spread round-robin
+        size_t target = (currentPool == this) ? currentWorker : nextQueue++ % queues.size();
+        {
+            std::lock_guard<std::mutex> guard(queues[target]->lock);
+            queues[target]->tasks.push_back({ std::move(fn), &group });
+        }
+        {
+            std::lock_guard<std::mutex> guard(sleepLock);
+            queued++;
+        }
+        wake.notify_one();
+    }
 
-        if (lowerArg == "--help" || lowerArg == "-help" || lowerArg == "-h") {
-            printUsage();
-            return 0;
+    // Long-running task that may itself submit() and wait(), such as one conversion of a batch
+    void submitJob(TaskGroup& group, std::function<void()> fn) {
+        group.pending++;
+        {
+            std::lock_guard<std::mutex> guard(jobLock);
+            jobs.push_back({ std::move(fn), &group });
         }
-        if (lowerArg == "--version" || lowerArg == "-version" || lowerArg == "-v") {
-            printVersion();
-            return 0;
+        {
+            std::lock_guard<std::mutex> guard(sleepLock);
+            queued++;
         }
-        if (lowerArg == "--debug" || lowerArg == "-debug" || lowerArg == "-d") {
-            debug = true;
-            debugPrint("Debug mode enabled.");
-        } 
-        else if (lowerArg == "--inputhex" || lowerArg == "-inputhex") {
-            std::cerr << "[ERROR]: Missing required path after --inputHex!\n";
-            std::cerr << "Use a required to type commands! --inputHex=<path> --outputFile=<path>\n\n";
-            std::cerr << "You must type --help to see all commands.\n";
-            return 1;
-        } 
-        else if (lowerArg == "--outputfile" || lowerArg == "-outputfile" || lowerArg == "-o" || lowerArg == "--outputfile=" || lowerArg == "-outputfile=" || lowerArg == "-o=") {
-            std::cerr << "[ERROR]: Invaild arguments way!\n";
-            std::cerr << "Use a required to type commands! --inputHex=<path> --outputFile=<path>\n\n";
-            std::cerr << "You must type --help to see all commands.\n";
-            return 1;
+        wake.notify_one();
+    }
+
+    // The waiting thread runs queued tasks itself, so waiting from inside a task cannot deadlock
+    void wait(TaskGroup& group) {
+        while (group.pending > 0) {
+            if (runOne(currentPool == this ? currentWorker : 0)) continue;
+            std::unique_lock<std::mutex> guard(group.lock);
+            group.done.wait_for(guard, std::chrono::milliseconds(1), [&] { return group.pending == 0; });
         }
-        else if (lowerArg.find("--inputhex=") == 0 || lowerArg.find("-inputhex=") == 0 || lowerArg == "-i") {
-            std::string value = arg.substr(arg.find("=") + 1);
-            if (value.empty()) {
-                std::cerr << "[ERROR]: Empty path given for --inputHex!\n";
-                std::cerr << "Use a required to type commands! --inputHex=<path> --outputFile=<path>\n\n";
-                std::cerr << "You must type --help to see all commands.\n";
-                return 1;
-            }
-            args["--inputHex"] = value;
-            inputHexFlagFound = true;
-            if (outputFileFlagFound) {
-                inputHexBeforeOutput = true;
+        settle(group);
+    }
+
+    // Like wait(), but gives up after 'timeout' so the caller can update progress; true once the group is done
+    bool waitFor(TaskGroup& group, std::chrono::milliseconds timeout) {
+        auto deadline = std::chrono::steady_clock::now() + timeout;
+        while (group.pending > 0) {
+            if (std::chrono::steady_clock::now() >= deadline) return false;
+            if (runOne(currentPool == this ? currentWorker : 0)) continue;
+            std::unique_lock<std::mutex> guard(group.lock);
+            group.done.wait_until(guard, std::min(deadline, std::chrono::steady_clock::now() + std::chrono::milliseconds(1)),
+                                  [&] { return group.pending == 0; });
+        }
+        settle(group);
+        return true;
+    }
+
+private:
+    struct Task {
+        std::function<void()> fn;
+        TaskGroup* group;
+    };
+    struct WorkQueue {
+        std::mutex lock;
+        RingBuffer<Task> tasks{64};
+    };
+
+    std::vector<std::unique_ptr<WorkQueue>> queues;
+    std::mutex jobLock;
+    RingBuffer<Task> jobs{16};
+    std::vector<std::thread> threads;
+    std::mutex sleepLock;
+    std::condition_variable wake;
+    size_t queued = 0; // guarded by sleepLock
+    bool stopping = false;
+    std::atomic<size_t> nextQueue{0};
+
+    static thread_local ThreadPool* currentPool;
+    static thread_local size_t currentWorker;
+
+    // The last task of a group may still be inside its notify; the group (usually on the caller's stack)
+    // must not be destroyed before that worker has released the lock
+    static void settle(TaskGroup& group) {
+        std::lock_guard<std::mutex> guard(group.lock);
+    }
+
+    bool takeTask(size_t self, bool takeJobs, Task& task) {
+        {
+            std::lock_guard<std::mutex> guard(queues[self]->lock);
+            if (!queues[self]->tasks.empty()) {
+                task = queues[self]->tasks.pop_back();
+                return true;
             }
-        } 
-        else if (lowerArg.find("--outputfile=") == 0 || lowerArg.find("-outputfile=") == 0 || lowerArg == "-o") {
-            std::string value = arg.substr(arg.find("=") + 1);
-            if (value.empty()) {
-                std::cerr << "[ERROR]: Empty path given for --outputFile!\n";
-                std::cerr << "Use a required to type commands! --inputHex=<path> --outputFile=<path>\n\n";
-                std::cerr << "You must type --help to see all commands.\n";
-                return 1;
+        }
+        for (size_t i = 1; i < queues.size(); ++i) {
+            WorkQueue& victim = *queues[(self + i) % queues.size()];
+            std::lock_guard<std::mutex> guard(victim.lock);
+            if (!victim.tasks.empty()) {
+                task = victim.tasks.pop_front();
+                return true;
             }
-            args["--outputFile"] = value;
-            outputFileFlagFound = true;
-            if (inputHexFlagFound) {
-                inputHexBeforeOutput = false;
+        }
+        if (takeJobs) {
+            std::lock_guard<std::mutex> guard(jobLock);
+            if (!jobs.empty()) {
+                task = jobs.pop_front();
+                return true;
             }
-        } 
-        else {
-            std::cerr << "[ERROR]: Unknown argument: " << arg << std::endl;
-            std::cerr << "You must type --help to see all commands.\n";
-            return 1;
         }
+        return false;
     }
 
-    // New backwards argument order error
-    if (!args.count("--inputHex") && !args.count("--outputFile") &&
-        inputHexFlagFound && outputFileFlagFound && inputHexBeforeOutput) {
-        std::cerr << "[ERROR]: Invaild way arguments! \n";
-        std::cerr << "Use a required to type commands! --inputHex=<path> --outputFile=<path>\n\n";
-        std::cerr << "You must type --help to see all commands.\n";
-        return 1;
+    bool runOne(size_t self, bool takeJobs = false) {
+        Task task;
+        if (!takeTask(self, takeJobs, task)) return false;
+        {
+            std::lock_guard<std::mutex> guard(sleepLock);
+            queued--;
+        }
+        task.fn();
+        // Decrement under the lock so a waiter that sees 0 cannot return (and drop the group) before the notify
+        std::lock_guard<std::mutex> guard(task.group->lock);
+        if (--task.group->pending == 0) task.group->done.notify_all();
+        return true;
     }
 
-    // Handling missing arguments and flags
-    if (!inputHexFlagFound || !outputFileFlagFound) {
-        std::cerr << "[ERROR]: Missing required arguments!\n";
-        std::cerr << "Use a required to type commands! --inputHex=<path> --outputFile=<path>\n\n";
-        std::cerr << "You must type --help to see all commands.\n";
-        return 1;
+    void workerLoop(size_t self) {
+        currentPool = this;
+        currentWorker = self;
+        setStatsRole("worker");
+        while (true) {
+            if (runOne(self, true)) continue;
+            std::unique_lock<std::mutex> guard(sleepLock);
+            wake.wait(guard, [&] { return stopping || queued > 0; });
+            if (stopping) return;
+        }
     }
+};
 
-    // Debugging path arguments
-    debugPrint("Input Path: " + args["--inputHex"]);
-    debugPrint("Output Path: " + args["--outputFile"]);
+thread_local ThreadPool* ThreadPool::currentPool = nullptr;
+thread_local size_t ThreadPool::currentWorker = 0;
 
-    // Extra debugging for the order of the flags
-    if (inputHexFlagFound && outputFileFlagFound) {
-        if (inputHexBeforeOutput) {
-            debugPrint("--inputHex flag found before --outputFile flag.");
+// Smallest slice of bytes worth handing to a worker
+const size_t MIN_TASK_SLICE = 64 * 1024;
+
+// Live elapsed/remaining/speed line (once per second) and the progress bar (at most ten times per second)
+void printConversionStatus(std::chrono::steady_clock::time_point startTime, size_t doneBytes, size_t totalEstimatedBytes, long& lastPrintedTick) {
+    auto currentTime = std::chrono::steady_clock::now();
+    long tick = static_cast<long>(std::chrono::duration_cast<std::chrono::milliseconds>(currentTime - startTime).count() / 100);
+    if (tick == lastPrintedTick) return;
+    bool newSecond = lastPrintedTick < 0 || tick / 10 != lastPrintedTick / 10;
+    lastPrintedTick = tick;
+
+    // LIVE TIMER DISPLAY - NEW
+    long elapsed = tick / 10;
+    if (newSecond) {
+
+        double bytesPerSec = (tick > 0) ? static_cast<double>(doneBytes) / (tick / 10.0) : 0.0;
+        size_t estRemainSecs = (bytesPerSec > 0) ? static_cast<size_t>((totalEstimatedBytes - doneBytes) / bytesPerSec) : 0;
+
+        int hrs = static_cast<int>(elapsed / 3600);
+        int mins = static_cast<int>((elapsed % 3600) / 60);
+        int secs = static_cast<int>(elapsed % 60);
+
+        std::ostringstream timerInfo;
+        timerInfo << "Conversion Progress Status: [Elapsed: "
+                << std::setw(2) << std::setfill('0') << hrs << ":"
+                << std::setw(2) << std::setfill('0') << mins << ":"
+                << std::setw(2) << std::setfill('0') << secs << " | ";
+
+        // Calculate remaining time if any
+        if (estRemainSecs > 0) {
+            int rhrs = static_cast<int>(estRemainSecs / 3600);
+            int rmins = static_cast<int>((estRemainSecs % 3600) / 60);
+            int rsecs = static_cast<int>(estRemainSecs % 60);
+
+            timerInfo << "Remaining: " << rhrs << "h " << rmins << "m " << rsecs << "s";
         } else {
-            debugPrint("--outputFile flag found before --inputHex flag.");
+            timerInfo << "Remaining: 00h 00m 00s";
         }
+
+        // Show speed
+        timerInfo << " | Speed Rate: ";
+        if (bytesPerSec >= 1024.0 * 1024.0 * 1024.0) {
+            timerInfo << std::fixed << std::setprecision(2)
+                    << (bytesPerSec / (1024.0 * 1024.0 * 1024.0)) << " GB/s]";
+        } else if (bytesPerSec >= 1024.0 * 1024.0) {
+            timerInfo << std::fixed << std::setprecision(2)
+                    << (bytesPerSec / (1024.0 * 1024.0)) << " MB/s]";
+        } else if (bytesPerSec >= 1024.0) {
+            timerInfo << std::fixed << std::setprecision(2)
+                    << (bytesPerSec / 1024.0) << " KB/s]";
+        } else {
+            timerInfo << std::fixed << std::setprecision(2)
+                    << bytesPerSec << " B/s";
+        }
+
+        // Ensure output fits fixed width (if you want the text output to stay within the terminal width)
+        std::string outStr = timerInfo.str();
+        outStr.resize(120, ' '); // Adjust width as needed (120 chars here for example)
+
+        // Print the progress in the same line (overwrites previous)
+        std::cout << "\r" << outStr << std::flush;
     }
+    printProgress(doneBytes, totalEstimatedBytes);
+}
 
-    // Check for invalid argument order (reversed flags with values)
-    if (inputHexFlagFound && outputFileFlagFound && inputHexBeforeOutput) {
+// --sparse: whole HOLE_BLOCKs of the output file that decode to zeros are left as holes instead of written
+bool sparseOutput = false;
+const size_t HOLE_BLOCK = 4096;
+
+// Zero flags for the whole HOLE_BLOCKs (aligned to the output file) inside one decoded buffer
+struct ZeroMap {
+    size_t origin = 0;      // first block boundary, relative to the buffer
+    std::vector<char> zero; // one flag per whole block from 'origin' on
+
+    // Lays the grid over 'length' bytes that go to file offset 'offset'
+    void reset(uint64_t offset, size_t length) {
+        origin = static_cast<size_t>((HOLE_BLOCK - offset % HOLE_BLOCK) % HOLE_BLOCK);
+        zero.assign(length > origin ? (length - origin) / HOLE_BLOCK : 0, 0);
+    }
+};
+
+bool isZeroBlock(const char* data, size_t n) {
+    size_t i = 0;
+#ifdef __SSE2__
+    for (; i + 64 <= n; i += 64) {
+        const __m128i* p = reinterpret_cast<const __m128i*>(data + i);
+        __m128i any = _mm_or_si128(_mm_or_si128(_mm_loadu_si128(p), _mm_loadu_si128(p + 1)),
+                                   _mm_or_si128(_mm_loadu_si128(p + 2), _mm_loadu_si128(p + 3)));
+        if (_mm_movemask_epi8(_mm_cmpeq_epi8(any, _mm_setzero_si128())) != 0xFFFF) return false;
+    }
+#endif
+    for (; i < n; ++i) {
+        if (data[i] != 0) return false;
+    }
+    return true;
+}
+
+// Decodes like a kernel, but one output HOLE_BLOCK at a time so each whole block is tested for zeros while it is
+// still in L1. 'lead' bytes come before the first block boundary; 'zeroFlags' gets one flag per whole block.
+// With 'skipZeros' blocks are decoded into a scratch block and only copied out when non-zero, so a zero block
+// of a fresh memory-mapped output is never touched and stays a hole.
+size_t decodeFindingZeros(const char* hex, size_t numBytes, char* out, size_t lead, char* zeroFlags, bool skipZeros) {
+    thread_local char scratch[HOLE_BLOCK];
+    size_t done = std::min(lead, numBytes);
+    if (done > 0 && decodeKernel.decode(hex, done, out) != done) return 0;
+    for (; done + HOLE_BLOCK <= numBytes; done += HOLE_BLOCK) {
+        char* dest = skipZeros ? scratch : out + done;
+        if (decodeKernel.decode(hex + 2 * done, HOLE_BLOCK, dest) != HOLE_BLOCK) return done;
+        bool zero = isZeroBlock(dest, HOLE_BLOCK);
+        *zeroFlags++ = zero;
+        if (skipZeros && !zero) std::memcpy(out + done, scratch, HOLE_BLOCK);
+    }
+    return done + decodeKernel.decode(hex + 2 * done, numBytes - done, out + done);
+}
+
+// Convert a hex chunk to bytes using multi-core/threading, 'out' must hold hexLen / 2 bytes
+// Returns false if the chunk holds a non-hex character. With 'zeros' (--sparse) the whole hole blocks are flagged too.
+bool hexStringToBytesParallel(const char* hex, size_t hexLen, char* out, ThreadPool& pool, ZeroMap* zeros = nullptr) {
+    size_t numBytes = hexLen / 2;
+
+    // A few slices per worker so idle cores can steal from busy ones
+    size_t numSlices = std::max<size_t>(1, std::min<size_t>(pool.size() * 4, numBytes / MIN_TASK_SLICE));
+    size_t slicePerTask = numBytes / numSlices;
+    size_t leftover = numBytes % numSlices;
+
+    // Slice boundaries after the first snap to the hole grid, so every whole block belongs to one slice
+    auto boundary = [&](size_t t) {
+        size_t pos = t * slicePerTask + std::min(t, leftover);
+        if (!zeros || t == 0 || t == numSlices) return pos;
+        size_t grid = pos <= zeros->origin ? zeros->origin
+                                           : zeros->origin + (pos - zeros->origin + HOLE_BLOCK - 1) / HOLE_BLOCK * HOLE_BLOCK;
+        return std::min(grid, numBytes);
+    };
+
+    std::atomic<bool> valid(true);
+    auto convert = [&](size_t t) {
+        size_t start = boundary(t);
+        size_t end = boundary(t + 1);
+        StageTimer timer(Stage::Decode, end - start);
+        size_t decoded;
+        if (zeros) {
+            size_t lead = start < zeros->origin ? zeros->origin - start : 0;
+            char* flags = zeros->zero.data() + (start < zeros->origin ? 0 : (start - zeros->origin) / HOLE_BLOCK);
+            decoded = decodeFindingZeros(hex + start * 2, end - start, out + start, lead, flags, false);
+        } else {
+            decoded = decodeKernel.decode(hex + start * 2, end - start, out + start);
+        }
+        if (decoded != end - start) valid = false;
+    };
+
+    // Tasks capture just two words so std::function keeps them inline instead of allocating
+    TaskGroup group;
+    for (size_t t = 0; t < numSlices; ++t) {
+        pool.submit(group, [&convert, t] { convert(t); });
+    }
+    pool.wait(group);
+    return valid;
+}
+
+// Encode a block of bytes to hex text using multi-core/threading, returns the characters written to 'out'
+size_t bytesToHexParallel(const unsigned char* in, size_t n, size_t firstIndex, bool atEnd, char* out, ThreadPool& pool) {
+    size_t numSlices = std::max<size_t>(1, std::min<size_t>(pool.size() * 4, n / MIN_TASK_SLICE));
+    size_t slicePerTask = n / numSlices;
+    size_t leftover = n % numSlices;
+
+    auto convert = [&](size_t t) {
+        size_t start = t * slicePerTask + std::min(t, leftover);
+        size_t end = start + slicePerTask + ((t < leftover) ? 1 : 0);
+        StageTimer timer(Stage::Encode, end - start);
+        encodeRange(encodeFormat, in + start, firstIndex + start, end - start, atEnd && end == n,
+                    out + encodedLength(encodeFormat, firstIndex, start, false));
+    };
+
+    TaskGroup group;
+    for (size_t t = 0; t < numSlices; ++t) {
+        pool.submit(group, [&convert, t] { convert(t); });
+    }
+    pool.wait(group);
+    return encodedLength(encodeFormat, firstIndex, n, atEnd);
+}
+
+// Fixed-capacity FIFO between two pipeline stages. Records how deep it got and
+// how long each side spent blocked, so --debug can show which stage is the bottleneck.
+template <typename T>
+class BoundedQueue {
+public:
+    BoundedQueue(const char* name, size_t capacity) : name(name), capacity(capacity), items(capacity) {}
+
+    // Blocks while full; returns false once the queue is closed
+    bool push(T item) {
+        std::unique_lock<std::mutex> guard(lock);
+        if (items.size() >= capacity && !closed) {
+            auto start = std::chrono::steady_clock::now();
+            notFull.wait(guard, [&] { return items.size() < capacity || closed; });
+            pushStall += std::chrono::steady_clock::now() - start;
+        }
+        if (closed) return false;
+        items.push_back(std::move(item));
+        peakDepth = std::max(peakDepth, items.size());
+        notEmpty.notify_one();
+        return true;
+    }
+
+    // Blocks while empty; returns false once the queue is closed and drained
+    bool pop(T& item) {
+        std::unique_lock<std::mutex> guard(lock);
+        if (items.empty() && !closed) {
+            auto start = std::chrono::steady_clock::now();
+            notEmpty.wait(guard, [&] { return !items.empty() || closed; });
+            popStall += std::chrono::steady_clock::now() - start;
+        }
+        if (items.empty()) return false;
+        item = items.pop_front();
+        notFull.notify_one();
+        return true;
+    }
+
+    void close() {
+        std::lock_guard<std::mutex> guard(lock);
+        closed = true;
+        notFull.notify_all();
+        notEmpty.notify_all();
+    }
+
+    std::string report() {
+        std::lock_guard<std::mutex> guard(lock);
+        std::ostringstream oss;
+        oss << std::fixed << std::setprecision(2)
+            << "Queue '" << name << "': depth " << peakDepth << "/" << capacity
+            << " peak, producer stalled " << std::chrono::duration<double, std::milli>(pushStall).count()
+            << " ms, consumer stalled " << std::chrono::duration<double, std::milli>(popStall).count() << " ms";
+        return oss.str();
+    }
+
+private:
+    const char* name;
+    size_t capacity;
+    std::mutex lock;
+    std::condition_variable notFull, notEmpty;
+    RingBuffer<T> items;
+    bool closed = false;
+    size_t peakDepth = 0;
+    std::chrono::steady_clock::duration pushStall{0}, popStall{0};
+};
+
+const size_t PIPELINE_BUFFERS = 6;
+
+// One block travelling through the pipeline. The same few chunks are recycled for the whole conversion.
+struct PipelineChunk {
+    std::vector<char> in;   // raw block as read, 1 spare byte in front for a hex digit carried over by the sanitizer
+    size_t inStart = 1;     // where the payload begins (0 when a carried digit was prepended)
+    size_t inLen = 0;
+    std::vector<char> out;  // bytes handed to the writer
+    size_t outLen = 0;
+    size_t inputBytes = 0;  // raw input bytes this chunk consumed
+    size_t firstIndex = 0;  // offset of in[inStart] within the whole input
+    bool last = false;      // nothing follows this chunk
+    int carryOut = -1;      // odd hex digit the sanitizer held back for the next chunk
+    ZeroMap zeros;          // --sparse: zero blocks of 'out' the writer skips
+
+    PipelineChunk(size_t inCapacity, size_t outCapacity) : in(inCapacity + 1), out(outCapacity) {
+        zeros.zero.reserve(outCapacity / HOLE_BLOCK + 1);
+    }
+};
+
+// Reader and writer threads with the bounded queues around them. The caller runs whatever stages sit in
+// between, popping from 'readQueue' and pushing finished chunks to 'writeQueue'. Shared by decode and encode.
+class StreamPipeline {
+public:
+    BoundedQueue<PipelineChunk*> freeChunks{"free", PIPELINE_BUFFERS};
+    BoundedQueue<PipelineChunk*> readQueue;
+    BoundedQueue<PipelineChunk*> writeQueue;
+    std::atomic<bool> aborted{false}, readFailed{false}, writeFailed{false};
+    std::atomic<size_t> readSize; // bytes per chunk the reader asks for, up to the capacity (--adaptive lowers it)
+    size_t writtenBytes = 0; // only the writer thread touches it until finish()
+    size_t holeBytes = 0;    // of those, skipped over as holes (--sparse)
+
+    // 'firstOffset' is where 'input' is positioned (non-zero when resuming); 'onWritten' runs on the
+    // writer thread after each chunk reached 'output'
+    StreamPipeline(std::istream& input, std::ostream& output, size_t inCapacity, size_t outCapacity,
+                   const char* readQueueName, const char* writeQueueName, size_t firstOffset = 0,
+                   std::function<void(const PipelineChunk&)> onWritten = nullptr)
+        : readQueue(readQueueName, PIPELINE_BUFFERS), writeQueue(writeQueueName, PIPELINE_BUFFERS), readSize(inCapacity),
+          onWritten(std::move(onWritten)) {
+        for (size_t i = 0; i < PIPELINE_BUFFERS; ++i) {
+            chunkStore.emplace_back(new PipelineChunk(inCapacity, outCapacity));
+            freeChunks.push(chunkStore.back().get());
+        }
+        reader = std::thread(&StreamPipeline::readLoop, this, std::ref(input), inCapacity, firstOffset);
+        writer = std::thread(&StreamPipeline::writeLoop, this, std::ref(output));
+    }
+
+    ~StreamPipeline() {
+        abort();
+        finish();
+    }
+
+    // Stop every stage; blocked pushes and pops return false
+    void abort() {
+        aborted = true;
+        freeChunks.close();
+        readQueue.close();
+        writeQueue.close();
+    }
+
+    // Call once the middle stages pushed their last chunk
+    void finish() {
+        if (reader.joinable()) reader.join();
+        writeQueue.close();
+        if (writer.joinable()) writer.join();
+    }
+
+    void debugReport() {
+        debugPrint(readQueue.report());
+        debugPrint(writeQueue.report());
+        debugPrint(freeChunks.report());
+    }
+
+private:
+    std::vector<std::unique_ptr<PipelineChunk>> chunkStore;
+    std::function<void(const PipelineChunk&)> onWritten;
+    std::thread reader, writer;
+
+    // Runs of zero blocks are seeked over, leaving holes. A run that ends the chunk keeps its last byte,
+    // so the file is always as long as what was written (the journal and --resume rely on that).
+    void writeChunk(std::ostream& output, const PipelineChunk& chunk) {
+        const std::vector<char>& zero = chunk.zeros.zero;
+        size_t pos = 0, k = 0;
+        while (k < zero.size()) {
+            if (!zero[k]) {
+                ++k;
+                continue;
+            }
+            size_t first = k;
+            while (k < zero.size() && zero[k]) ++k;
+            size_t holeStart = chunk.zeros.origin + first * HOLE_BLOCK;
+            size_t holeEnd = chunk.zeros.origin + k * HOLE_BLOCK;
+            if (holeEnd == chunk.outLen) --holeEnd;
+            output.write(chunk.out.data() + pos, static_cast<std::streamsize>(holeStart - pos));
+            output.seekp(static_cast<std::streamoff>(holeEnd - holeStart), std::ios::cur);
+            holeBytes += holeEnd - holeStart;
+            pos = holeEnd;
+        }
+        output.write(chunk.out.data() + pos, static_cast<std::streamsize>(chunk.outLen - pos));
+    }
+
+    void readLoop(std::istream& input, size_t capacity, size_t offset) {
+        setStatsRole("reader");
+        PipelineChunk* chunk;
+        while (freeChunks.pop(chunk)) {
+            StageTimer timer(Stage::Read, 0);
+            size_t wanted = std::min<size_t>(capacity, readSize);
+            input.read(chunk->in.data() + 1, static_cast<std::streamsize>(wanted));
+            chunk->inStart = 1;
+            chunk->inLen = static_cast<size_t>(input.gcount());
+            timer.setBytes(chunk->inLen);
+            timer.stop();
+            chunk->inputBytes = chunk->inLen;
+            chunk->firstIndex = offset;
+            chunk->carryOut = -1;
+            // read() only comes back short at the end of the input. A full chunk that happens to end it is
+            // followed by an empty last one; peeking ahead would hold this chunk until more input arrived.
+            bool last = chunk->inLen < wanted;
+            chunk->last = last;
+            offset += chunk->inLen;
+            if (!readQueue.push(chunk) || last) break;
+        }
+        if (input.bad()) readFailed = true;
+        readQueue.close();
+    }
+
+    void writeLoop(std::ostream& output) {
+        setStatsRole("writer");
+        PipelineChunk* chunk;
+        while (writeQueue.pop(chunk)) {
+            StageTimer timer(Stage::Write, chunk->outLen);
+            writeChunk(output, *chunk);
+            timer.stop();
+            if (!output) {
+                writeFailed = true;
+                abort();
+                break;
+            }
+            writtenBytes += chunk->outLen;
+            if (onWritten) onWritten(*chunk);
+            freeChunks.push(chunk);
+        }
+        // Buffered backends still hold the tail; a failure there is a failed write too
+        if (!writeFailed && !output.flush()) writeFailed = true;
+    }
+};
+
+// CRC-32C (Castagnoli). Takes and returns the finished value, so calls chain like zlib's crc32().
+struct Crc32cTable {
+    uint32_t value[256] = {};
+    constexpr Crc32cTable() {
+        for (uint32_t i = 0; i < 256; ++i) {
+            uint32_t crc = i;
+            for (int bit = 0; bit < 8; ++bit) crc = (crc >> 1) ^ ((crc & 1) ? 0x82F63B78u : 0);
+            value[i] = crc;
+        }
+    }
+};
+constexpr Crc32cTable CRC32C_TABLE{};
+
+uint32_t crc32cScalar(uint32_t crc, const char* data, size_t n) {
+    crc = ~crc;
+    for (size_t i = 0; i < n; ++i) crc = CRC32C_TABLE.value[(crc ^ static_cast<unsigned char>(data[i])) & 0xFF] ^ (crc >> 8);
+    return ~crc;
+}
+
+#ifdef HEX2FILE_X86
+__attribute__((target("sse4.2")))
+uint32_t crc32cSSE42(uint32_t crc, const char* data, size_t n) {
+    uint64_t state = ~crc;
+    size_t i = 0;
+#ifdef __x86_64__
+    for (; i + 8 <= n; i += 8) {
+        uint64_t word;
+        std::memcpy(&word, data + i, 8);
+        state = _mm_crc32_u64(state, word);
+    }
+#endif
+    uint32_t crc32 = static_cast<uint32_t>(state);
+    for (; i < n; ++i) crc32 = _mm_crc32_u8(crc32, static_cast<unsigned char>(data[i]));
+    return ~crc32;
+}
+#endif
+
+uint32_t crc32c(uint32_t crc, const char* data, size_t n) {
+#ifdef HEX2FILE_X86
+    static const bool hardware = (__builtin_cpu_init(), __builtin_cpu_supports("sse4.2"));
+    if (hardware) return crc32cSSE42(crc, data, n);
+#endif
+    return crc32cScalar(crc, data, n);
+}
+
+// Appends the CRC of a second block of 'len2' bytes to 'crc1' (zlib's crc32_combine, Castagnoli polynomial),
+// so blocks checksummed on different threads fold into the CRC of the whole output
+uint32_t gf2MatrixTimes(const uint32_t* matrix, uint32_t vector) {
+    uint32_t sum = 0;
+    for (; vector; vector >>= 1, ++matrix) {
+        if (vector & 1) sum ^= *matrix;
+    }
+    return sum;
+}
+
+void gf2MatrixSquare(uint32_t* square, const uint32_t* matrix) {
+    for (int n = 0; n < 32; ++n) square[n] = gf2MatrixTimes(matrix, matrix[n]);
+}
+
+uint32_t crc32cCombine(uint32_t crc1, uint32_t crc2, uint64_t len2) {
+    if (len2 == 0) return crc1;
+    uint32_t even[32], odd[32];
+    odd[0] = 0x82F63B78u;
+    for (int n = 1; n < 32; ++n) odd[n] = 1u << (n - 1);
+    gf2MatrixSquare(even, odd); // two zero bits
+    gf2MatrixSquare(odd, even); // four zero bits
+    while (true) {
+        gf2MatrixSquare(even, odd);
+        if (len2 & 1) crc1 = gf2MatrixTimes(even, crc1);
+        len2 >>= 1;
+        if (len2 == 0) break;
+        gf2MatrixSquare(odd, even);
+        if (len2 & 1) crc1 = gf2MatrixTimes(odd, crc1);
+        len2 >>= 1;
+        if (len2 == 0) break;
+    }
+    return crc1 ^ crc2;
+}
+
+// Streaming XXH3-64 with seed 0 and the default secret, matching xxhsum -H3
+class Xxh3Stream {
+public:
+    void update(const char* data, size_t n) {
+        const unsigned char* input = reinterpret_cast<const unsigned char*>(data);
+        const unsigned char* end = input + n;
+        totalLen += n;
+        if (bufferedSize + n <= BUFFER_SIZE) {
+            std::memcpy(buffer + bufferedSize, input, n);
+            bufferedSize += n;
+            return;
+        }
+        if (bufferedSize > 0) {
+            size_t load = BUFFER_SIZE - bufferedSize;
+            std::memcpy(buffer + bufferedSize, input, load);
+            input += load;
+            consumeStripes(acc, stripesSoFar, buffer, BUFFER_STRIPES);
+            bufferedSize = 0;
+        }
+        if (end - input > static_cast<std::ptrdiff_t>(BUFFER_SIZE)) {
+            do {
+                consumeStripes(acc, stripesSoFar, input, BUFFER_STRIPES);
+                input += BUFFER_SIZE;
+            } while (end - input > static_cast<std::ptrdiff_t>(BUFFER_SIZE));
+            // The last stripe before the tail may be needed again by digest()
+            std::memcpy(buffer + BUFFER_SIZE - STRIPE_LEN, input - STRIPE_LEN, STRIPE_LEN);
+        }
+        bufferedSize = static_cast<size_t>(end - input);
+        std::memcpy(buffer, input, bufferedSize);
+    }
+
+    uint64_t digest() const {
+        if (totalLen <= 240) return hashShort(buffer, static_cast<size_t>(totalLen));
+        uint64_t accCopy[8];
+        std::memcpy(accCopy, acc, sizeof(acc));
+        size_t stripes = stripesSoFar;
+        unsigned char lastStripe[STRIPE_LEN];
+        const unsigned char* last;
+        if (bufferedSize >= STRIPE_LEN) {
+            consumeStripes(accCopy, stripes, buffer, (bufferedSize - 1) / STRIPE_LEN);
+            last = buffer + bufferedSize - STRIPE_LEN;
+        } else {
+            size_t catchup = STRIPE_LEN - bufferedSize;
+            std::memcpy(lastStripe, buffer + BUFFER_SIZE - catchup, catchup);
+            std::memcpy(lastStripe + catchup, buffer, bufferedSize);
+            last = lastStripe;
+        }
+        accumulateStripe(accCopy, last, SECRET + SECRET_SIZE - STRIPE_LEN - 7);
+        return mergeAccs(accCopy, SECRET + 11, totalLen * P64_1);
+    }
+
+private:
+    static const size_t STRIPE_LEN = 64, SECRET_SIZE = 192, BUFFER_SIZE = 256, BUFFER_STRIPES = BUFFER_SIZE / STRIPE_LEN;
+    static const size_t STRIPES_PER_BLOCK = (SECRET_SIZE - STRIPE_LEN) / 8;
+    static constexpr uint64_t P32_1 = 0x9E3779B1u, P32_2 = 0x85EBCA77u, P32_3 = 0xC2B2AE3Du;
+    static constexpr uint64_t P64_1 = 0x9E3779B185EBCA87ull, P64_2 = 0xC2B2AE3D27D4EB4Full, P64_3 = 0x165667B19E3779F9ull;
+    static constexpr uint64_t P64_4 = 0x85EBCA77C2B2AE63ull, P64_5 = 0x27D4EB2F165667C5ull;
+    static constexpr unsigned char SECRET[SECRET_SIZE] = {
+        0xb8, 0xfe, 0x6c, 0x39, 0x23, 0xa4, 0x4b, 0xbe, 0x7c, 0x01, 0x81, 0x2c, 0xf7, 0x21, 0xad, 0x1c,
+        0xde, 0xd4, 0x6d, 0xe9, 0x83, 0x90, 0x97, 0xdb, 0x72, 0x40, 0xa4, 0xa4, 0xb7, 0xb3, 0x67, 0x1f,
+        0xcb, 0x79, 0xe6, 0x4e, 0xcc, 0xc0, 0xe5, 0x78, 0x82, 0x5a, 0xd0, 0x7d, 0xcc, 0xff, 0x72, 0x21,
+        0xb8, 0x08, 0x46, 0x74, 0xf7, 0x43, 0x24, 0x8e, 0xe0, 0x35, 0x90, 0xe6, 0x81, 0x3a, 0x26, 0x4c,
+        0x3c, 0x28, 0x52, 0xbb, 0x91, 0xc3, 0x00, 0xcb, 0x88, 0xd0, 0x65, 0x8b, 0x1b, 0x53, 0x2e, 0xa3,
+        0x71, 0x64, 0x48, 0x97, 0xa2, 0x0d, 0xf9, 0x4e, 0x38, 0x19, 0xef, 0x46, 0xa9, 0xde, 0xac, 0xd8,
+        0xa8, 0xfa, 0x76, 0x3f, 0xe3, 0x9c, 0x34, 0x3f, 0xf9, 0xdc, 0xbb, 0xc7, 0xc7, 0x0b, 0x4f, 0x1d,
+        0x8a, 0x51, 0xe0, 0x4b, 0xcd, 0xb4, 0x59, 0x31, 0xc8, 0x9f, 0x7e, 0xc9, 0xd9, 0x78, 0x73, 0x64,
+        0xea, 0xc5, 0xac, 0x83, 0x34, 0xd3, 0xeb, 0xc3, 0xc5, 0x81, 0xa0, 0xff, 0xfa, 0x13, 0x63, 0xeb,
+        0x17, 0x0d, 0xdd, 0x51, 0xb7, 0xf0, 0xda, 0x49, 0xd3, 0x16, 0x55, 0x26, 0x29, 0xd4, 0x68, 0x9e,
+        0x2b, 0x16, 0xbe, 0x58, 0x7d, 0x47, 0xa1, 0xfc, 0x8f, 0xf8, 0xb8, 0xd1, 0x7a, 0xd0, 0x31, 0xce,
+        0x45, 0xcb, 0x3a, 0x8f, 0x95, 0x16, 0x04, 0x28, 0xaf, 0xd7, 0xfb, 0xca, 0xbb, 0x4b, 0x40, 0x7e,
+    };
+
+    uint64_t acc[8] = { P32_3, P64_1, P64_2, P64_3, P64_4, P32_2, P64_5, P32_1 };
+    unsigned char buffer[BUFFER_SIZE];
+    size_t bufferedSize = 0, stripesSoFar = 0;
+    uint64_t totalLen = 0;
+
+    static uint64_t read64(const unsigned char* p) { uint64_t v; std::memcpy(&v, p, 8); return v; }
+    static uint32_t read32(const unsigned char* p) { uint32_t v; std::memcpy(&v, p, 4); return v; }
+    static uint64_t rotl64(uint64_t x, int r) { return (x << r) | (x >> (64 - r)); }
+    static uint64_t swap64(uint64_t x) { return __builtin_bswap64(x); }
+
+    static uint64_t mulFold64(uint64_t a, uint64_t b) {
+        unsigned __int128 product = static_cast<unsigned __int128>(a) * b;
+        return static_cast<uint64_t>(product) ^ static_cast<uint64_t>(product >> 64);
+    }
+    static uint64_t xxh64Avalanche(uint64_t h) {
+        h ^= h >> 33; h *= P64_2; h ^= h >> 29; h *= P64_3; return h ^ (h >> 32);
+    }
+    static uint64_t avalanche(uint64_t h) {
+        h ^= h >> 37; h *= 0x165667919E3779F9ull; return h ^ (h >> 32);
+    }
+    static uint64_t rrmxmx(uint64_t h, uint64_t len) {
+        h ^= rotl64(h, 49) ^ rotl64(h, 24);
+        h *= 0x9FB21C651E98DF25ull;
+        h ^= (h >> 35) + len;
+        h *= 0x9FB21C651E98DF25ull;
+        return h ^ (h >> 28);
+    }
+    static uint64_t mix16(const unsigned char* input, const unsigned char* secret) {
+        return mulFold64(read64(input) ^ read64(secret), read64(input + 8) ^ read64(secret + 8));
+    }
+
+    static uint64_t hashShort(const unsigned char* input, size_t len) {
+        const unsigned char* secret = SECRET;
+        if (len == 0) return xxh64Avalanche(read64(secret + 56) ^ read64(secret + 64));
+        if (len <= 3) {
+            uint32_t combined = (static_cast<uint32_t>(input[0]) << 16) | (static_cast<uint32_t>(input[len >> 1]) << 24)
+                              | input[len - 1] | (static_cast<uint32_t>(len) << 8);
+            return xxh64Avalanche(combined ^ static_cast<uint64_t>(read32(secret) ^ read32(secret + 4)));
+        }
+        if (len <= 8) {
+            uint64_t keyed = (read32(input + len - 4) + (static_cast<uint64_t>(read32(input)) << 32)) ^ (read64(secret + 8) ^ read64(secret + 16));
+            return rrmxmx(keyed, len);
+        }
+        if (len <= 16) {
+            uint64_t lo = read64(input) ^ (read64(secret + 24) ^ read64(secret + 32));
+            uint64_t hi = read64(input + len - 8) ^ (read64(secret + 40) ^ read64(secret + 48));
+            return avalanche(len + swap64(lo) + hi + mulFold64(lo, hi));
+        }
+        uint64_t acc = len * P64_1;
+        if (len <= 128) {
+            if (len > 32) {
+                if (len > 64) {
+                    if (len > 96) {
+                        acc += mix16(input + 48, secret + 96);
+                        acc += mix16(input + len - 64, secret + 112);
+                    }
+                    acc += mix16(input + 32, secret + 64);
+                    acc += mix16(input + len - 48, secret + 80);
+                }
+                acc += mix16(input + 16, secret + 32);
+                acc += mix16(input + len - 32, secret + 48);
+            }
+            acc += mix16(input, secret);
+            acc += mix16(input + len - 16, secret + 16);
+            return avalanche(acc);
+        }
+        for (size_t i = 0; i < 8; ++i) acc += mix16(input + 16 * i, secret + 16 * i);
+        uint64_t accEnd = mix16(input + len - 16, secret + 136 - 17);
+        acc = avalanche(acc);
+        for (size_t i = 8; i < len / 16; ++i) accEnd += mix16(input + 16 * i, secret + 16 * (i - 8) + 3);
+        return avalanche(acc + accEnd);
+    }
+
+    static void accumulateStripe(uint64_t* acc, const unsigned char* input, const unsigned char* secret) {
+        for (size_t i = 0; i < 8; ++i) {
+            uint64_t value = read64(input + 8 * i);
+            uint64_t key = value ^ read64(secret + 8 * i);
+            acc[i ^ 1] += value;
+            acc[i] += (key & 0xFFFFFFFFu) * (key >> 32);
+        }
+    }
+    static void scramble(uint64_t* acc) {
+        const unsigned char* secret = SECRET + SECRET_SIZE - STRIPE_LEN;
+        for (size_t i = 0; i < 8; ++i) {
+            uint64_t value = acc[i];
+            value ^= value >> 47;
+            value ^= read64(secret + 8 * i);
+            acc[i] = value * P32_1;
+        }
+    }
+    static void consumeStripes(uint64_t* acc, size_t& stripesSoFar, const unsigned char* input, size_t stripes) {
+        for (size_t s = 0; s < stripes; ++s) {
+            accumulateStripe(acc, input + s * STRIPE_LEN, SECRET + stripesSoFar * 8);
+            if (++stripesSoFar == STRIPES_PER_BLOCK) {
+                scramble(acc);
+                stripesSoFar = 0;
+            }
+        }
+    }
+    static uint64_t mergeAccs(const uint64_t* acc, const unsigned char* secret, uint64_t start) {
+        uint64_t result = start;
+        for (size_t i = 0; i < 4; ++i) {
+            result += mulFold64(acc[2 * i] ^ read64(secret + 16 * i), acc[2 * i + 1] ^ read64(secret + 16 * i + 8));
+        }
+        return avalanche(result);
+    }
+};
+constexpr unsigned char Xxh3Stream::SECRET[];
+
+// SHA-256 compression, scalar and with the x86 SHA extensions
+const uint32_t SHA256_K[64] = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+    0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+    0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+    0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+    0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2,
+};
+
+void sha256BlocksScalar(uint32_t* state, const unsigned char* data, size_t blocks) {
+    auto rotr = [](uint32_t x, int r) { return (x >> r) | (x << (32 - r)); };
+    for (; blocks > 0; --blocks, data += 64) {
+        uint32_t w[64];
+        for (int i = 0; i < 16; ++i) {
+            w[i] = (static_cast<uint32_t>(data[4 * i]) << 24) | (static_cast<uint32_t>(data[4 * i + 1]) << 16)
+                 | (static_cast<uint32_t>(data[4 * i + 2]) << 8) | data[4 * i + 3];
+        }
+        for (int i = 16; i < 64; ++i) {
+            uint32_t s0 = rotr(w[i - 15], 7) ^ rotr(w[i - 15], 18) ^ (w[i - 15] >> 3);
+            uint32_t s1 = rotr(w[i - 2], 17) ^ rotr(w[i - 2], 19) ^ (w[i - 2] >> 10);
+            w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+        }
+        uint32_t a = state[0], b = state[1], c = state[2], d = state[3], e = state[4], f = state[5], g = state[6], h = state[7];
+        for (int i = 0; i < 64; ++i) {
+            uint32_t t1 = h + (rotr(e, 6) ^ rotr(e, 11) ^ rotr(e, 25)) + ((e & f) ^ (~e & g)) + SHA256_K[i] + w[i];
+            uint32_t t2 = (rotr(a, 2) ^ rotr(a, 13) ^ rotr(a, 22)) + ((a & b) ^ (a & c) ^ (b & c));
+            h = g; g = f; f = e; e = d + t1; d = c; c = b; b = a; a = t1 + t2;
+        }
+        state[0] += a; state[1] += b; state[2] += c; state[3] += d;
+        state[4] += e; state[5] += f; state[6] += g; state[7] += h;
+    }
+}
+
+#ifdef HEX2FILE_X86
+__attribute__((target("sha,ssse3,sse4.1")))
+void sha256BlocksSHA(uint32_t* state, const unsigned char* data, size_t blocks) {
+    const __m128i byteSwap = _mm_set_epi64x(0x0c0d0e0f08090a0bll, 0x0405060700010203ll);
+    __m128i tmp = _mm_shuffle_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(state)), 0xB1);     // CDAB
+    __m128i state1 = _mm_shuffle_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(state + 4)), 0x1B); // EFGH
+    __m128i state0 = _mm_alignr_epi8(tmp, state1, 8);   // ABEF
+    state1 = _mm_blend_epi16(state1, tmp, 0xF0);       // CDGH
+
+    for (; blocks > 0; --blocks, data += 64) {
+        __m128i abefSave = state0, cdghSave = state1;
+        __m128i msg[4];
+        for (int i = 0; i < 16; ++i) {
+            if (i < 4) msg[i] = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(data + 16 * i)), byteSwap);
+            __m128i rounds = _mm_add_epi32(msg[i % 4], _mm_loadu_si128(reinterpret_cast<const __m128i*>(SHA256_K + 4 * i)));
+            state1 = _mm_sha256rnds2_epu32(state1, state0, rounds);
+            if (i >= 3 && i < 15) {
+                __m128i& next = msg[(i + 1) % 4];
+                next = _mm_sha256msg2_epu32(_mm_add_epi32(next, _mm_alignr_epi8(msg[i % 4], msg[(i + 3) % 4], 4)), msg[i % 4]);
+            }
+            state0 = _mm_sha256rnds2_epu32(state0, state1, _mm_shuffle_epi32(rounds, 0x0E));
+            if (i >= 1 && i < 13) msg[(i + 3) % 4] = _mm_sha256msg1_epu32(msg[(i + 3) % 4], msg[i % 4]);
+        }
+        state0 = _mm_add_epi32(state0, abefSave);
+        state1 = _mm_add_epi32(state1, cdghSave);
+    }
+
+    tmp = _mm_shuffle_epi32(state0, 0x1B);        // FEBA
+    state1 = _mm_shuffle_epi32(state1, 0xB1);     // DCHG
+    state0 = _mm_blend_epi16(tmp, state1, 0xF0);  // DCBA
+    state1 = _mm_alignr_epi8(state1, tmp, 8);     // HGFE
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(state), state0);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(state + 4), state1);
+}
+#endif
+
+class Sha256Stream {
+public:
+    void update(const char* data, size_t n) {
+        const unsigned char* input = reinterpret_cast<const unsigned char*>(data);
+        totalLen += n;
+        if (buffered > 0) {
+            size_t take = std::min(n, sizeof(buffer) - buffered);
+            std::memcpy(buffer + buffered, input, take);
+            buffered += take;
+            input += take;
+            n -= take;
+            if (buffered < sizeof(buffer)) return;
+            compress(state, buffer, 1);
+            buffered = 0;
+        }
+        compress(state, input, n / 64);
+        std::memcpy(buffer, input + n / 64 * 64, n % 64);
+        buffered = n % 64;
+    }
+
+    std::string hex() const {
+        uint32_t result[8];
+        std::memcpy(result, state, sizeof(state));
+        unsigned char tail[128] = {};
+        std::memcpy(tail, buffer, buffered);
+        tail[buffered] = 0x80;
+        size_t tailLen = buffered < 56 ? 64 : 128;
+        uint64_t bits = totalLen * 8;
+        for (int i = 0; i < 8; ++i) tail[tailLen - 1 - i] = static_cast<unsigned char>(bits >> (8 * i));
+        compress(result, tail, tailLen / 64);
+        std::ostringstream out;
+        for (uint32_t word : result) out << std::hex << std::setw(8) << std::setfill('0') << word;
+        return out.str();
+    }
+
+private:
+    uint32_t state[8] = { 0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19 };
+    unsigned char buffer[64];
+    size_t buffered = 0;
+    uint64_t totalLen = 0;
+
+    static void compress(uint32_t* state, const unsigned char* data, size_t blocks) {
+        if (blocks == 0) return;
+#ifdef HEX2FILE_X86
+        static const bool hardware = (__builtin_cpu_init(), __builtin_cpu_supports("sha") && __builtin_cpu_supports("sse4.1"));
+        if (hardware) return sha256BlocksSHA(state, data, blocks);
+#endif
+        sha256BlocksScalar(state, data, blocks);
+    }
+};
+
+// --digest: checksum of the output, fed in output order as the data is produced
+enum class DigestKind { None, Crc32c, Xxh3, Sha256 };
+DigestKind digestKind = DigestKind::None;
+std::string expectedDigest; // --expect, lowercase hex
+
+const char* digestName(DigestKind kind) {
+    switch (kind) {
+        case DigestKind::Crc32c: return "crc32c";
+        case DigestKind::Xxh3: return "xxh3";
+        case DigestKind::Sha256: return "sha256";
+        default: return "none";
+    }
+}
+
+bool parseDigestKind(const std::string& name, DigestKind& kind) {
+    for (DigestKind candidate : { DigestKind::Crc32c, DigestKind::Xxh3, DigestKind::Sha256 }) {
+        if (name == digestName(candidate)) {
+            kind = candidate;
+            return true;
+        }
+    }
+    return false;
+}
+
+class OutputDigest {
+public:
+    explicit OutputDigest(DigestKind kind) : kind(kind) {}
+
+    DigestKind algorithm() const { return kind; }
+
+    void update(const char* data, size_t n) {
+        switch (kind) {
+            case DigestKind::Crc32c: crc = crc32c(crc, data, n); break;
+            case DigestKind::Xxh3: xxh3.update(data, n); break;
+            case DigestKind::Sha256: sha256.update(data, n); break;
+            default: break;
+        }
+    }
+
+    // CRC-32C only: the next 'n' bytes were checksummed elsewhere, e.g. per block on the pool
+    void appendCrc(uint32_t blockCrc, size_t n) { crc = crc32cCombine(crc, blockCrc, n); }
+
+    std::string hex() const {
+        std::ostringstream out;
+        out << std::hex << std::setfill('0');
+        switch (kind) {
+            case DigestKind::Crc32c: out << std::setw(8) << crc; break;
+            case DigestKind::Xxh3: out << std::setw(16) << xxh3.digest(); break;
+            case DigestKind::Sha256: return sha256.hex();
+            default: break;
+        }
+        return out.str();
+    }
+
+private:
+    DigestKind kind;
+    uint32_t crc = 0;
+    Xxh3Stream xxh3;
+    Sha256Stream sha256;
+};
+
+// Checkpoint journal for --journal/--resume, kept next to the output as "<output>.h2fjournal".
+// It is written as soon as the output is open, then the writer thread advances it after every chunk.
+// About once a second, and once more when the conversion stops, the output is flushed and the journal is replaced in one rename, so the file
+// on disk always describes a prefix of the output that really was handed to the OS.
+class ConversionJournal {
+public:
+    struct Checkpoint {
+        uint64_t inputOffset = 0;  // raw input bytes fully accounted for
+        uint64_t outputOffset = 0; // output bytes they produced
+        int carry = -1;            // odd hex digit held back for the next chunk at that point
+        uint32_t digest = 0;       // CRC-32C of output[0, outputOffset)
+    };
+
+    // 'identity' pins the input file and the conversion settings; a journal for anything else is refused
+    ConversionJournal(const std::string& outputPath, const std::string& identity)
+        : outputPath(outputPath), journalPath(outputPath + ".h2fjournal"), identity(identity) {}
+
+    const std::string& path() const { return journalPath; }
+    const Checkpoint& start() const { return resumed; }
+
+    // Loads the checkpoint, checks the output prefix against its digest and cuts the output back to it
+    bool resume(std::string& error) {
+        std::ifstream file(journalPath, std::ios::binary);
+        if (!file.is_open()) {
+            error = "No journal to resume from! (" + journalPath + ")";
+            return false;
+        }
+        std::stringstream contents;
+        contents << file.rdbuf();
+        std::string text = contents.str();
+        if (text.compare(0, identity.size(), identity) != 0) {
+            error = "Journal was written for a different input file or settings! (" + journalPath + ")";
+            return false;
+        }
+        std::istringstream fields(text.substr(identity.size()));
+        std::string key;
+        Checkpoint checkpoint;
+        bool complete = false;
+        while (fields >> key) {
+            if (key == "input-offset") fields >> checkpoint.inputOffset;
+            else if (key == "output-offset") fields >> checkpoint.outputOffset;
+            else if (key == "carry") fields >> checkpoint.carry;
+            else if (key == "digest") {
+                fields >> std::hex >> checkpoint.digest >> std::dec;
+                complete = static_cast<bool>(fields);
+            }
+        }
+        if (!complete) {
+            error = "Journal is damaged! (" + journalPath + ")";
+            return false;
+        }
+
+        // The output must still hold exactly what the journal says was written
+        std::error_code ec;
+        uintmax_t outputSize = std::filesystem::file_size(outputPath, ec);
+        std::ifstream output(outputPath, std::ios::binary);
+        uint32_t digest = 0;
+        if (!ec && outputSize >= checkpoint.outputOffset && output.is_open()) {
+            std::vector<char> buffer(8 * 1024 * 1024);
+            uint64_t remaining = checkpoint.outputOffset;
+            while (remaining > 0 && output) {
+                output.read(buffer.data(), static_cast<std::streamsize>(std::min<uint64_t>(remaining, buffer.size())));
+                digest = crc32c(digest, buffer.data(), static_cast<size_t>(output.gcount()));
+                remaining -= static_cast<uint64_t>(output.gcount());
+                if (output.gcount() == 0) break;
+            }
+            if (remaining != 0) digest = ~checkpoint.digest;
+        }
+        if (ec || outputSize < checkpoint.outputOffset || digest != checkpoint.digest) {
+            error = "Output file does not match its journal, convert again without --resume! (" + outputPath + ")";
+            return false;
+        }
+        output.close();
+        std::filesystem::resize_file(outputPath, checkpoint.outputOffset, ec);
+        if (ec) {
+            error = "Unable to cut the output back to the last checkpoint!";
+            return false;
+        }
+        resumed = latest = durable = checkpoint;
+        lastSave = std::chrono::steady_clock::now();
+        return true;
+    }
+
+    // A fresh conversion records the empty prefix before any output is written, so a run killed
+    // before its first timed checkpoint can still be resumed (from the start)
+    bool begin() { return save(); }
+
+    // Writer thread, after 'chunk' went to 'output'
+    void chunkWritten(const PipelineChunk& chunk, std::ostream& output) {
+        latest.digest = crc32c(latest.digest, chunk.out.data(), chunk.outLen);
+        latest.outputOffset += chunk.outLen;
+        latest.inputOffset = chunk.firstIndex + chunk.inputBytes;
+        latest.carry = chunk.carryOut;
+        if (std::chrono::steady_clock::now() - lastSave >= std::chrono::seconds(1)) checkpoint(output);
+    }
+
+    // Once the pipeline stopped: a finished conversion drops the journal, anything else leaves a last checkpoint
+    void finish(std::ostream& output, bool converted) {
+        if (converted) {
+            std::error_code ec;
+            std::filesystem::remove(journalPath, ec);
+            return;
+        }
+        checkpoint(output);
+        std::cerr << "Progress saved at " << formatSize(durable.outputOffset) << " of output, run again with --resume to continue. ("
+                  << journalPath << ")" << std::endl;
+    }
+
+private:
+    std::string outputPath, journalPath, identity;
+    Checkpoint resumed, latest, durable;
+    std::chrono::steady_clock::time_point lastSave = std::chrono::steady_clock::now();
+
+    void checkpoint(std::ostream& output) {
+        lastSave = std::chrono::steady_clock::now();
+        output.flush();
+        if (output) durable = latest;
+        save();
+    }
+
+    // Replaces the journal on disk with the durable checkpoint in one rename
+    bool save() {
+        std::string partial = journalPath + ".partial";
+        {
+            std::ofstream file(partial, std::ios::binary | std::ios::trunc);
+            file << identity << "input-offset " << durable.inputOffset << "\noutput-offset " << durable.outputOffset
+                 << "\ncarry " << durable.carry << "\ndigest " << std::hex << durable.digest << "\n";
+            if (!file.flush()) return false;
+        }
+        std::error_code ec;
+        std::filesystem::rename(partial, journalPath, ec);
+        return !ec;
+    }
+};
+
+// Heap allocations and bytes moved while converting (progress display excluded), scaled per MB of output
+std::string allocationReport(size_t allocations, size_t copied, size_t outputBytes) {
+    double mb = static_cast<double>(outputBytes) / (1024.0 * 1024.0);
+    std::ostringstream oss;
+    oss << std::fixed << std::setprecision(2)
+        << "Heap allocations during conversion: " << allocations << " (" << (mb > 0 ? allocations / mb : 0.0) << " per MB)"
+        << ", bytes copied: " << copied << " (" << (mb > 0 ? copied / mb : 0.0) << " per MB)";
+    return oss.str();
+}
+
+// One input -> output conversion and how it went
+struct ConversionJob {
+    std::string inputPath, outputPath;
+    bool interactive = true; // progress display and Tab + ESC polling, off for batch jobs
+    bool mapped = false;     // memory-mapped converters instead of the streamed pipeline
+    std::chrono::steady_clock::time_point startTime;
+    bool ok = false;
+    std::string error;       // why it failed, shown as "[ERROR]: <error>"
+    std::string summary;     // extra line for the final report, if any
+    ConversionJournal* journal = nullptr; // --journal: checkpoints of the streamed converters
+    DigestKind digestKind = DigestKind::None; // --digest for this job
+    OutputDigest* digest = nullptr;       // --digest: fed with the output in order as it is produced
+    std::string digestHex;                // the finished --digest value
+    bool invalidHex = false;              // failed on bad hex text, convertFile() adds where
+    size_t inputBytes = 0, outputBytes = 0;
+    size_t holeBytes = 0;    // part of the output left as holes (--sparse)
+    double seconds = 0.0;
+};
+
+// Set by Tab + ESC; every running conversion stops at its next check
+std::atomic<bool> abortRequested{false};
+
+bool failJob(ConversionJob& job, const std::string& error) {
+    job.error = error;
+    return false;
+}
+
+bool failInvalidHex(ConversionJob& job, bool oddDigits) {
+    job.invalidHex = true;
+    return failJob(job, oddDigits ? "Odd number of hex characters!" : "Not a valid hex file!");
+}
+
+// Polls Tab + ESC on interactive runs; true once a stop was requested from anywhere
+bool conversionAborted(const ConversionJob& job) {
+    if (job.interactive && !abortRequested && checkTabEscExit()) {
+        abortRequested = true;
+        std::cout << "\nExiting conversion as requested by user (Tab + ESC).\n" << std::endl;
+    }
+    return abortRequested;
+}
+
+// Final 100% bar of an interactive run
+void finishProgress(const ConversionJob& job) {
+    if (!job.interactive) return;
+    printProgress(job.outputBytes, job.outputBytes);
+    std::cout << std::endl;
+}
+
+// "-" as a path means standard input or output
+bool isStdioPath(const std::string& path) {
+    return path == "-";
+}
+
+// Unbuffered std::streambuf over a file descriptor for stdin/stdout pipelines. The pipeline
+// reads and writes whole chunks, so each chunk becomes read()/write() calls straight into or
+// out of its buffer, with no iostream buffer copy in between.
+class FdStreamBuf : public std::streambuf {
+public:
+    explicit FdStreamBuf(int fd) : fd(fd) { setg(&peeked, &peeked + 1, &peeked + 1); }
+
+protected:
+    // Only reached through peek() and single characters; one byte is held back for them
+    int_type underflow() override {
+        if (readSome(&peeked, 1) != 1) return traits_type::eof();
+        setg(&peeked, &peeked, &peeked + 1);
+        return traits_type::to_int_type(peeked);
+    }
+
+    std::streamsize xsgetn(char* s, std::streamsize count) override {
+        std::streamsize done = 0;
+        if (count > 0 && gptr() < egptr()) {
+            *s = *gptr();
+            gbump(1);
+            done = 1;
+        }
+        while (done < count) {
+            std::streamsize n = readSome(s + done, count - done);
+            if (n <= 0) break;
+            done += n;
+        }
+        return done;
+    }
+
+    int_type overflow(int_type c) override {
+        if (traits_type::eq_int_type(c, traits_type::eof())) return traits_type::not_eof(c);
+        char ch = traits_type::to_char_type(c);
+        return xsputn(&ch, 1) == 1 ? c : traits_type::eof();
+    }
+
+    std::streamsize xsputn(const char* s, std::streamsize count) override {
+        std::streamsize done = 0;
+        while (done < count) {
+            unsigned int request = static_cast<unsigned int>(std::min<std::streamsize>(count - done, 1 << 30));
+#ifdef _WIN32
+            int n = _write(fd, s + done, request);
+#else
+            ssize_t n = ::write(fd, s + done, request);
+            if (n < 0 && errno == EINTR) continue;
+#endif
+            if (n <= 0) break;
+            done += n;
+        }
+        return done;
+    }
+
+private:
+    int fd;
+    char peeked;
+
+    // A read error surfaces as badbit on the istream
+    std::streamsize readSome(char* s, std::streamsize count) {
+        unsigned int request = static_cast<unsigned int>(std::min<std::streamsize>(count, 1 << 30));
+        while (true) {
+#ifdef _WIN32
+            int n = _read(fd, s, request);
+#else
+            ssize_t n = ::read(fd, s, request);
+            if (n < 0 && errno == EINTR) continue;
+#endif
+            if (n < 0) throw std::ios_base::failure("read failed");
+            return n;
+        }
+    }
+};
+
+// File I/O backend of the streamed converters (--io)
+enum class IoBackend { Stream, Posix, Uring };
+
+IoBackend ioBackend = IoBackend::Stream;
+bool directIo = false; // --direct: O_DIRECT, keep one-shot conversions out of the page cache
+
+const char* ioBackendName(IoBackend backend) {
+    switch (backend) {
+        case IoBackend::Posix: return "posix";
+        case IoBackend::Uring: return "uring";
+        default: return "stream";
+    }
+}
+
+#ifdef HEX2FILE_URING
+// Just enough io_uring for FileIoBuf, straight on the system calls (no liburing): readv/writev
+// submissions and their completions, one ring per open file
+class IoUring {
+public:
+    IoUring() = default;
+    IoUring(const IoUring&) = delete;
+    IoUring& operator=(const IoUring&) = delete;
+    ~IoUring() { close(); }
+
+    bool open(unsigned entries) {
+        io_uring_params params;
+        std::memset(&params, 0, sizeof(params));
+        ringFd = static_cast<int>(syscall(__NR_io_uring_setup, entries, &params));
+        if (ringFd < 0) return false;
+        sqRingBytes = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+        cqRingBytes = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+        bool singleMap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+        if (singleMap) sqRingBytes = cqRingBytes = std::max(sqRingBytes, cqRingBytes);
+        sqRing = mapRing(sqRingBytes, IORING_OFF_SQ_RING);
+        cqRing = singleMap ? sqRing : mapRing(cqRingBytes, IORING_OFF_CQ_RING);
+        sqeBytes = params.sq_entries * sizeof(io_uring_sqe);
+        sqes = reinterpret_cast<io_uring_sqe*>(mapRing(sqeBytes, IORING_OFF_SQES));
+        if (!sqRing || !cqRing || !sqes) {
+            close();
+            return false;
+        }
+        sqTail = reinterpret_cast<unsigned*>(sqRing + params.sq_off.tail);
+        sqMask = *reinterpret_cast<unsigned*>(sqRing + params.sq_off.ring_mask);
+        sqArray = reinterpret_cast<unsigned*>(sqRing + params.sq_off.array);
+        cqHead = reinterpret_cast<unsigned*>(cqRing + params.cq_off.head);
+        cqTail = reinterpret_cast<unsigned*>(cqRing + params.cq_off.tail);
+        cqMask = *reinterpret_cast<unsigned*>(cqRing + params.cq_off.ring_mask);
+        cqes = reinterpret_cast<io_uring_cqe*>(cqRing + params.cq_off.cqes);
+        return true;
+    }
+
+    // Queues one readv/writev of 'iov' at 'offset'; 'tag' comes back with its completion
+    void queue(bool write, int fd, const iovec* iov, uint64_t offset, uint64_t tag) {
+        unsigned tail = *sqTail;
+        unsigned index = tail & sqMask;
+        io_uring_sqe& sqe = sqes[index];
+        std::memset(&sqe, 0, sizeof(sqe));
+        sqe.opcode = write ? IORING_OP_WRITEV : IORING_OP_READV;
+        sqe.fd = fd;
+        sqe.addr = reinterpret_cast<uint64_t>(iov);
+        sqe.len = 1;
+        sqe.off = offset;
+        sqe.user_data = tag;
+        sqArray[index] = index;
+        __atomic_store_n(sqTail, tail + 1, __ATOMIC_RELEASE);
+        ++unsubmitted;
+    }
+
+    bool submit() {
+        while (unsubmitted > 0) {
+            long n = syscall(__NR_io_uring_enter, ringFd, unsubmitted, 0, 0, nullptr, 0);
+            if (n < 0 && errno == EINTR) continue;
+            if (n <= 0) return false;
+            unsubmitted -= static_cast<unsigned>(n);
+        }
+        return true;
+    }
+
+    // Blocks until the next completion; 'result' is the byte count or -errno
+    bool complete(uint64_t& tag, long& result) {
+        if (!submit()) return false;
+        while (true) {
+            unsigned head = *cqHead;
+            if (head != __atomic_load_n(cqTail, __ATOMIC_ACQUIRE)) {
+                const io_uring_cqe& cqe = cqes[head & cqMask];
+                tag = cqe.user_data;
+                result = cqe.res;
+                __atomic_store_n(cqHead, head + 1, __ATOMIC_RELEASE);
+                return true;
+            }
+            if (syscall(__NR_io_uring_enter, ringFd, 0, 1, IORING_ENTER_GETEVENTS, nullptr, 0) < 0 && errno != EINTR) return false;
+        }
+    }
+
+    void close() {
+        if (sqes) munmap(sqes, sqeBytes);
+        if (cqRing && cqRing != sqRing) munmap(cqRing, cqRingBytes);
+        if (sqRing) munmap(sqRing, sqRingBytes);
+        if (ringFd >= 0) ::close(ringFd);
+        sqes = nullptr;
+        sqRing = cqRing = nullptr;
+        ringFd = -1;
+        unsubmitted = 0;
+    }
+
+private:
+    int ringFd = -1;
+    char* sqRing = nullptr;
+    char* cqRing = nullptr;
+    io_uring_sqe* sqes = nullptr;
+    size_t sqRingBytes = 0, cqRingBytes = 0, sqeBytes = 0;
+    unsigned* sqTail = nullptr;
+    unsigned* sqArray = nullptr;
+    unsigned* cqHead = nullptr;
+    unsigned* cqTail = nullptr;
+    io_uring_cqe* cqes = nullptr;
+    unsigned sqMask = 0, cqMask = 0, unsubmitted = 0;
+
+    char* mapRing(size_t bytes, off_t offset) {
+        void* addr = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringFd, offset);
+        return addr == MAP_FAILED ? nullptr : static_cast<char*>(addr);
+    }
+};
+#endif
+
+#ifndef _WIN32
+// Whole-buffer pread/pwrite; returns the bytes done (short only at end of file) or -errno
+long preadFully(int fd, char* data, size_t length, uint64_t offset) {
+    size_t done = 0;
+    while (done < length) {
+        ssize_t n = ::pread(fd, data + done, length - done, static_cast<off_t>(offset + done));
+        if (n < 0 && errno == EINTR) continue;
+        if (n < 0) return -errno;
+        if (n == 0) break;
+        done += static_cast<size_t>(n);
+    }
+    return static_cast<long>(done);
+}
+
+long pwriteFully(int fd, const char* data, size_t length, uint64_t offset) {
+    size_t done = 0;
+    while (done < length) {
+        ssize_t n = ::pwrite(fd, data + done, length - done, static_cast<off_t>(offset + done));
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return n < 0 ? -errno : -EIO;
+        done += static_cast<size_t>(n);
+    }
+    return static_cast<long>(done);
+}
+
+// std::streambuf over a file for --io=posix|uring. A ring of page-aligned blocks keeps reads running ahead
+// of the reader thread and writes running behind the writer thread: through io_uring where the kernel
+// allows it, as plain pread/pwrite otherwise. With --direct the file is opened O_DIRECT; on file systems
+// that refuse it, pages are dropped from the cache right behind the conversion instead (posix_fadvise).
+class FileIoBuf : public std::streambuf {
+public:
+    FileIoBuf() = default;
+    FileIoBuf(const FileIoBuf&) = delete;
+    FileIoBuf& operator=(const FileIoBuf&) = delete;
+    ~FileIoBuf() override { close(); }
+
+    bool openRead(const std::string& path) {
+        if (!openFile(path, O_RDONLY)) return false;
+        struct stat st;
+        if (fstat(fd, &st) != 0) return false;
+        fileSize = static_cast<uint64_t>(st.st_size);
+#ifdef POSIX_FADV_SEQUENTIAL
+        if (!direct) posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
+        return true;
+    }
+
+    // 'keep': open an existing output without truncating it (resume), then seekp() to where writing continues
+    bool openWrite(const std::string& path, bool keep) {
+        writing = true;
+        if (!openFile(path, O_WRONLY | O_CREAT | (keep ? 0 : O_TRUNC))) return false;
+        return positionWrite(0);
+    }
+
+    // Flushes and releases everything; false if any write failed
+    bool close() {
+        bool ok = !writing || fd < 0 || sync() == 0;
+        if (dropCache && fd >= 0) dropBehind(writing ? nextOffset + static_cast<size_t>(pptr() - pbase()) : fileSize);
+#ifdef HEX2FILE_URING
+        ring.close();
+#endif
+        if (fd >= 0) ::close(fd);
+        if (plainFd >= 0) ::close(plainFd);
+        fd = plainFd = -1;
+        for (Block& block : blocks) std::free(block.data);
+        blocks.clear();
+        setg(nullptr, nullptr, nullptr);
+        setp(nullptr, nullptr);
+        return ok && !failed;
+    }
+
+    std::string describe() const {
+        std::string text = usingRing() ? "io_uring" : "pread/pwrite";
+        if (direct) text += ", O_DIRECT";
+        if (dropCache) text += ", cache dropped behind";
+        return text + ", " + std::to_string(blocks.size()) + " x " + formatSize(blockBytes) + " blocks";
+    }
+
+protected:
+    int_type underflow() override {
+        while (gptr() == egptr()) {
+            if (!started) {
+                startReads(startOffset);
+            } else if (exposed) {
+                exposed = false;
+                Block& done = blocks[current];
+                if (dropCache) dropBehind(done.offset + done.length);
+                requestRead(done);
+                current = (current + 1) % blocks.size();
+            }
+            Block& block = blocks[current];
+            if (block.length == 0) return traits_type::eof(); // nothing was requested past the end of the file
+            if (!wait(block)) throw std::ios_base::failure("read failed");
+            size_t expected = static_cast<size_t>(std::min<uint64_t>(block.length, fileSize - block.offset));
+            if (block.result < 0) throw std::ios_base::failure("read failed");
+            size_t got = static_cast<size_t>(block.result);
+            if (got < expected) {
+                // A short read before the end of the file: finish it through the page cache
+                long rest = preadFully(direct ? plainFd : fd, block.data + got, expected - got, block.offset + got);
+                if (rest < 0) throw std::ios_base::failure("read failed");
+                expected = got + static_cast<size_t>(rest);
+            }
+            exposed = true;
+            setg(block.data, block.data + std::min(skip, expected), block.data + expected);
+            skip = 0;
+        }
+        return traits_type::to_int_type(*gptr());
+    }
+
+    int_type overflow(int_type c) override {
+        if (!writing || failed) return traits_type::eof();
+        if (pptr() == epptr()) {
+            Block& full = blocks[current];
+            full.offset = nextOffset;
+            full.length = blockBytes;
+            issue(full, true);
+            nextOffset += blockBytes;
+            current = (current + 1) % blocks.size();
+            Block& next = blocks[current];
+            if (!finishWrite(next)) return traits_type::eof();
+            setp(next.data, next.data + blockBytes);
+        }
+        if (!traits_type::eq_int_type(c, traits_type::eof())) {
+            *pptr() = traits_type::to_char_type(c);
+            pbump(1);
+        }
+        return traits_type::not_eof(c);
+    }
+
+    // Everything handed over so far reaches the file. A partly filled block is written through the page cache
+    // (O_DIRECT needs whole sectors) and stays in place, to be written again in full once it fills up.
+    int sync() override {
+        if (!writing) return 0;
+        size_t pending = static_cast<size_t>(pptr() - pbase());
+        if (pending > 0 && pwriteFully(direct ? plainFd : fd, pbase(), pending, nextOffset) < 0) failed = true;
+        for (Block& block : blocks) {
+            if (!finishWrite(block)) failed = true;
+        }
+        return failed ? -1 : 0;
+    }
+
+    pos_type seekoff(off_type off, std::ios_base::seekdir dir, std::ios_base::openmode) override {
+        uint64_t position;
+        if (writing) {
+            position = nextOffset + static_cast<size_t>(pptr() - pbase());
+        } else {
+            position = exposed ? blocks[current].offset + static_cast<size_t>(gptr() - eback()) : startOffset;
+        }
+        if (dir == std::ios_base::beg) position = 0;
+        if (dir == std::ios_base::end) position = fileEnd();
+        return seekpos(pos_type(static_cast<off_type>(position) + off), std::ios_base::in | std::ios_base::out);
+    }
+
+    pos_type seekpos(pos_type pos, std::ios_base::openmode) override {
+        if (pos < 0) return pos_type(off_type(-1));
+        uint64_t target = static_cast<uint64_t>(static_cast<off_type>(pos));
+        if (writing) {
+            if (target == nextOffset + static_cast<size_t>(pptr() - pbase())) return pos;
+            if (sync() != 0 || !positionWrite(target)) return pos_type(off_type(-1));
+        } else {
+            waitAll();
+            startOffset = target;
+            started = false;
+            exposed = false;
+            setg(nullptr, nullptr, nullptr);
+        }
+        return pos;
+    }
+
+private:
+    struct Block {
+        char* data = nullptr;
+        uint64_t offset = 0;
+        size_t length = 0;  // bytes requested, 0 = nothing in this block
+        bool busy = false;  // submitted to the ring, completion not reaped yet
+        long result = 0;    // bytes transferred or -errno
+        iovec iov;
+    };
+    static const size_t ALIGNMENT = 4096;
+    static const size_t DEPTH = 4;
+
+    int fd = -1;
+    int plainFd = -1;           // O_DIRECT only: a descriptor through the page cache for unaligned pieces
+    bool writing = false, direct = false, dropCache = false, failed = false;
+    bool started = false, exposed = false;
+    uint64_t fileSize = 0;      // reading: where the input ends
+    uint64_t startOffset = 0;   // reading: where seekg() asked to start
+    uint64_t nextOffset = 0;    // reading: next block to request; writing: where the current block starts
+    uint64_t droppedUpTo = 0;
+    size_t blockBytes = 0, current = 0, skip = 0;
+    std::vector<Block> blocks;
+#ifdef HEX2FILE_URING
+    IoUring ring;
+    bool ringOpen = false;
+#endif
+
+    bool usingRing() const {
+#ifdef HEX2FILE_URING
+        return ringOpen;
+#else
+        return false;
+#endif
+    }
+
+    bool openFile(const std::string& path, int flags) {
+#ifdef O_DIRECT
+        if (directIo) {
+            fd = ::open(path.c_str(), flags | O_DIRECT, 0644);
+            direct = fd >= 0;
+            if (direct) plainFd = ::open(path.c_str(), writing ? O_RDWR : O_RDONLY);
+            if (direct && plainFd < 0) return false;
+        }
+#endif
+        if (fd < 0) {
+            fd = ::open(path.c_str(), flags, 0644);
+            dropCache = directIo;
+        }
+        if (fd < 0) return false;
+
+        // Block size follows --maxMemory like the pipeline chunks do
+        blockBytes = memoryCap ? std::max<size_t>(64 * 1024, std::min<size_t>(memoryCap / 16, 1 << 20)) & ~(ALIGNMENT - 1) : (1 << 20);
+        blocks.resize(DEPTH);
+        for (Block& block : blocks) {
+            void* data = nullptr;
+            if (posix_memalign(&data, ALIGNMENT, blockBytes) != 0) return false;
+            block.data = static_cast<char*>(data);
+        }
+#ifdef HEX2FILE_URING
+        if (ioBackend == IoBackend::Uring) {
+            ringOpen = ring.open(static_cast<unsigned>(DEPTH));
+            if (!ringOpen) debugPrint("io_uring is not available here, using pread/pwrite");
+        }
+#endif
+        return true;
+    }
+
+    uint64_t fileEnd() const {
+        if (!writing) return fileSize;
+        struct stat st;
+        uint64_t onDisk = fstat(fd, &st) == 0 ? static_cast<uint64_t>(st.st_size) : 0;
+        return std::max<uint64_t>(onDisk, nextOffset + static_cast<size_t>(pptr() - pbase()));
+    }
+
+    void issue(Block& block, bool write) {
+        block.iov.iov_base = block.data;
+        block.iov.iov_len = block.length;
+#ifdef HEX2FILE_URING
+        if (ringOpen) {
+            ring.queue(write, fd, &block.iov, block.offset, static_cast<uint64_t>(&block - blocks.data()));
+            block.busy = true;
+            if (ring.submit()) return;
+            block.busy = false; // the kernel refused the submission; do this one the plain way
+        }
+#endif
+        block.result = write ? pwriteFully(fd, block.data, block.length, block.offset)
+                             : preadFully(fd, block.data, block.length, block.offset);
+    }
+
+    bool wait(Block& block) {
+#ifdef HEX2FILE_URING
+        while (block.busy) {
+            uint64_t tag;
+            long result;
+            if (!ring.complete(tag, result)) return false;
+            blocks[tag].busy = false;
+            blocks[tag].result = result;
+        }
+#else
+        (void)block;
+#endif
+        return true;
+    }
+
+    void waitAll() {
+        for (Block& block : blocks) wait(block);
+    }
+
+    void requestRead(Block& block) {
+        block.length = 0;
+        if (nextOffset >= fileSize) return;
+        block.offset = nextOffset;
+        block.length = blockBytes;
+        nextOffset += blockBytes;
+        issue(block, false);
+    }
+
+    void startReads(uint64_t offset) {
+        uint64_t base = direct ? offset & ~static_cast<uint64_t>(ALIGNMENT - 1) : offset;
+        skip = static_cast<size_t>(offset - base);
+        nextOffset = base;
+        droppedUpTo = base;
+        current = 0;
+        for (Block& block : blocks) requestRead(block);
+        started = true;
+    }
+
+    // Reaps a block's write and completes it if it came back short; false on a write error
+    bool finishWrite(Block& block) {
+        if (!wait(block)) return false;
+        if (block.length == 0) return true;
+        long done = block.result;
+        if (done >= 0 && static_cast<size_t>(done) < block.length) {
+            long rest = pwriteFully(direct ? plainFd : fd, block.data + done, block.length - done, block.offset + done);
+            done = rest < 0 ? rest : done + rest;
+        }
+        if (dropCache) dropBehind(block.offset);
+        block.length = 0;
+        return done >= 0;
+    }
+
+    // Starts writing at 'target'. O_DIRECT writes whole aligned blocks, so the bytes between the aligned
+    // start and 'target' are read back into the first block. A seek past the end (--sparse skipping a hole)
+    // has nothing to read back there, and those bytes are zeros.
+    bool positionWrite(uint64_t target) {
+        nextOffset = direct ? target & ~static_cast<uint64_t>(ALIGNMENT - 1) : target;
+        droppedUpTo = nextOffset;
+        current = 0;
+        Block& block = blocks[current];
+        setp(block.data, block.data + blockBytes);
+        size_t head = static_cast<size_t>(target - nextOffset);
+        if (head > 0) {
+            long got = preadFully(plainFd, block.data, head, nextOffset);
+            if (got < 0) return false;
+            std::memset(block.data + got, 0, head - static_cast<size_t>(got));
+            pbump(static_cast<int>(head));
+        }
+        return true;
+    }
+
+    // --direct without O_DIRECT support: push finished pages out and drop them from the page cache
+    void dropBehind(uint64_t upTo) {
+        if (upTo <= droppedUpTo) return;
+#ifdef __linux__
+        if (writing) sync_file_range(fd, static_cast<off_t>(droppedUpTo), static_cast<off_t>(upTo - droppedUpTo), SYNC_FILE_RANGE_WRITE);
+#endif
+#ifdef POSIX_FADV_DONTNEED
+        posix_fadvise(fd, static_cast<off_t>(droppedUpTo), static_cast<off_t>(upTo - droppedUpTo), POSIX_FADV_DONTNEED);
+#endif
+        droppedUpTo = upTo;
+    }
+};
+#endif
+
+// Pipeline chunk size for streamed conversions: 'wanted', by default --chunkSize, the tuning profile or CHUNK_SIZE_HEX.
+// With --maxMemory the buffers in flight are sized to fit under the cap; the chunk size never depends on line length.
+size_t streamChunkBytes(size_t outputPerInputByte, size_t wanted = 0) {
+    if (wanted == 0) wanted = chunkSizeHex ? chunkSizeHex : CHUNK_SIZE_HEX;
+    if (memoryCap == 0) return wanted;
+    size_t chunk = memoryCap / (PIPELINE_BUFFERS * (1 + outputPerInputByte));
+    return std::max<size_t>(4096, std::min(chunk, wanted)) & ~static_cast<size_t>(1);
+}
+
+// Bounds of --adaptive chunk sizes. Buffers are allocated for the largest one up front.
+const size_t ADAPTIVE_MIN_CHUNK = 256 * 1024;
+const size_t ADAPTIVE_MAX_CHUNK = 8 * 1024 * 1024;
+
+// --adaptive: hill-climbs the chunk size of a streamed conversion on the measured time per input byte.
+// Sizes double or halve between the bounds. Each size is judged on a window of chunks that were read at
+// that size, so chunks still in flight from the previous size do not count. Growing stops once a chunk
+// takes longer than MAX_LATENCY_NS, which keeps progress and Tab + ESC responsive.
+class ChunkTuner {
+public:
+    ChunkTuner(size_t initial, size_t minBytes, size_t maxBytes)
+        : current(initial), minBytes(std::min(minBytes, initial)), maxBytes(std::max(maxBytes, initial)) {}
+
+    size_t size() const { return current; }
+
+    // One chunk of 'bytes' input took 'ns' to pass the decode stage; returns the size to read from now on
+    size_t record(size_t bytes, uint64_t ns) {
+        if (settled || bytes != current) return current;
+        windowNs += ns;
+        if (++windowChunks < WINDOW) return current;
+        double cost = static_cast<double>(windowNs) / (static_cast<double>(current) * windowChunks);
+        bool slow = windowNs / windowChunks > MAX_LATENCY_NS;
+        windowNs = 0;
+        windowChunks = 0;
+
+        // A clear gain (or the first measurement) keeps going the same way. Otherwise, or at a bound,
+        // go back to the better size and try the other direction once before settling.
+        bool gain = previous == 0 || cost < previousCost * (1.0 - TOLERANCE);
+        if (gain) {
+            previous = current;
+            previousCost = cost;
+            if (step(direction, slow)) return current;
+        } else {
+            current = previous;
+        }
+        if (!reversed) {
+            reversed = true;
+            direction = -direction;
+            if (step(direction, gain && slow)) return current;
+        }
+        settled = true;
+        return current;
+    }
+
+private:
+    static const size_t WINDOW = 4;
+    static constexpr double TOLERANCE = 0.03;
+    static const uint64_t MAX_LATENCY_NS = 250000000;
+
+    size_t current, minBytes, maxBytes;
+    size_t previous = 0;
+    double previousCost = 0.0;
+    uint64_t windowNs = 0;
+    size_t windowChunks = 0;
+    int direction = 1;
+    bool reversed = false, settled = false;
+
+    // Moves 'previous' one step in 'way' when the bounds (and latency, when growing) allow it
+    bool step(int way, bool slow) {
+        size_t next = way > 0 ? previous * 2 : previous / 2;
+        if (next < minBytes || next > maxBytes || (way > 0 && slow)) return false;
+        current = next;
+        return true;
+    }
+};
+
+// Runs on the writer thread after every chunk of the streamed converters: digest first, then the journal checkpoint
+std::function<void(const PipelineChunk&)> chunkWrittenHook(ConversionJob& job, std::ostream& output) {
+    ConversionJournal* journal = job.journal;
+    OutputDigest* digest = job.digest;
+    if (!journal && !digest) return nullptr;
+    return [journal, digest, &output](const PipelineChunk& chunk) {
+        if (digest) {
+            StageTimer timer(Stage::Digest, chunk.outLen);
+            digest->update(chunk.out.data(), chunk.outLen);
+        }
+        if (journal) journal->chunkWritten(chunk, output);
+    };
+}
+
+// Streamed conversion: reader, sanitizer, pooled decode and writer stages joined by bounded queues
+bool convertStreamed(std::istream& input, std::ostream& output, ThreadPool& pool, ConversionJob& job) {
+    size_t chunkBytes = streamChunkBytes(1);
+    // --adaptive: the buffers hold the largest chunk the tuner may move to, the reader starts at the usual size
+    size_t capacity = adaptiveChunks ? streamChunkBytes(1, std::max(chunkBytes, ADAPTIVE_MAX_CHUNK)) : chunkBytes;
+    ChunkTuner tuner(chunkBytes, ADAPTIVE_MIN_CHUNK, capacity);
+    ConversionJournal* journal = job.journal;
+    StreamPipeline pipeline(input, output, capacity, capacity / 2 + 1, "read -> sanitize", "decode -> write",
+                            journal ? journal->start().inputOffset : 0, chunkWrittenHook(job, output));
+    pipeline.readSize = chunkBytes;
+    BoundedQueue<PipelineChunk*> toDecode("sanitize -> decode", PIPELINE_BUFFERS);
+    int danglingChar = -1; // odd hex digit left over at end of input, set by the sanitizer
+
+    // Stage 2: strip whitespace in place, keep every chunk an even number of hex digits.
+    // Digits before the first whitespace already sit where they belong, so dense input is never moved.
+    std::atomic<size_t> bytesCopied(0);
+    std::thread sanitizer([&] {
+        setStatsRole("sanitizer");
+        PipelineChunk* chunk;
+        int carry = journal ? journal->start().carry : -1;
+        while (pipeline.readQueue.pop(chunk)) {
+            StageTimer timer(Stage::Sanitize, chunk->inLen);
+            char* text = chunk->in.data();
+            size_t end = chunk->inLen + 1;
+            size_t i = 1;
+            while (i < end && !isSpaceChar(text[i])) ++i;
+            size_t firstSpace = i, len = i;
+            for (; i < end; ++i) {
+                if (!isSpaceChar(text[i])) text[len++] = text[i];
+            }
+            bytesCopied += len - firstSpace;
+            chunk->inStart = 1;
+            if (carry >= 0) {
+                text[0] = static_cast<char>(carry);
+                chunk->inStart = 0;
+            }
+            chunk->inLen = len - chunk->inStart;
+            carry = (chunk->inLen % 2 != 0) ? static_cast<unsigned char>(text[chunk->inStart + --chunk->inLen]) : -1;
+            chunk->carryOut = carry;
+            timer.stop();
+            if (!toDecode.push(chunk)) break;
+        }
+        danglingChar = carry;
+        toDecode.close();
+    });
+
+    auto stopPipeline = [&](bool abort) {
+        if (abort) {
+            pipeline.abort();
+            toDecode.close();
+        }
+        sanitizer.join();
+        pipeline.finish();
+    };
+
+    // Stage 3: decode on the worker pool, right here on the calling thread
+    size_t decodedBytes = journal ? journal->start().outputOffset : 0;
+    size_t consumedInput = journal ? journal->start().inputOffset : 0;
+    long lastPrintedTick = -1;
+    size_t allocationsBefore = heapAllocations, displayAllocations = 0;
+    auto lastChunkTime = std::chrono::steady_clock::now();
+    PipelineChunk* chunk;
+    while (toDecode.pop(chunk)) {
+        if (pipeline.aborted) break;
+        chunk->outLen = chunk->inLen / 2;
+        if (sparseOutput) chunk->zeros.reset(decodedBytes, chunk->outLen);
+        if (!hexStringToBytesParallel(chunk->in.data() + chunk->inStart, chunk->inLen, chunk->out.data(), pool,
+                                      sparseOutput ? &chunk->zeros : nullptr)) {
+            stopPipeline(true);
+            return failInvalidHex(job, false);
+        }
+        decodedBytes += chunk->outLen;
+        consumedInput += chunk->inputBytes;
+        size_t chunkInput = chunk->last ? 0 : chunk->inputBytes;
+        if (!pipeline.writeQueue.push(chunk)) break;
+
+        // Time between chunks leaving this stage is the pipeline's pace, whichever stage holds it back
+        auto now = std::chrono::steady_clock::now();
+        if (adaptiveChunks && chunkInput > 0) {
+            size_t before = tuner.size();
+            pipeline.readSize = tuner.record(chunkInput, static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(now - lastChunkTime).count()));
+            size_t displayBefore = heapAllocations;
+            if (tuner.size() != before) debugPrint("Adaptive chunk size: " + formatSize(tuner.size()));
+            displayAllocations += heapAllocations - displayBefore;
+        }
+        lastChunkTime = now;
+
+        // Check if Tab + ESC is pressed to exit
+        if (conversionAborted(job)) {
+            stopPipeline(true);
+            return false;
+        }
+
+        size_t totalEstimatedBytes = (consumedInput > 0 && job.inputBytes > consumedInput)
+            ? static_cast<size_t>(static_cast<double>(decodedBytes) * job.inputBytes / consumedInput) : decodedBytes;
+        size_t displayBefore = heapAllocations;
+        if (job.interactive) printConversionStatus(job.startTime, decodedBytes, totalEstimatedBytes, lastPrintedTick);
+        displayAllocations += heapAllocations - displayBefore;
+    }
+    size_t steadyAllocations = heapAllocations - allocationsBefore - displayAllocations;
+    stopPipeline(false);
+    job.outputBytes = (journal ? journal->start().outputOffset : 0) + pipeline.writtenBytes;
+    job.holeBytes = pipeline.holeBytes;
+
+    if (pipeline.writeFailed) return failJob(job, "Unable to write data in your disk. It may be full or corrupted.");
+    if (pipeline.readFailed) return failJob(job, "Unable to read input hex file!");
+
+    // Odd hex digit left over at the very end
+    if (danglingChar >= 0) {
+        return failInvalidHex(job, isHexChar(static_cast<char>(danglingChar)));
+    }
+
+    finishProgress(job);
+
+    // Per-stage queue depths and stall times
+    pipeline.debugReport();
+    debugPrint(toDecode.report());
+    debugPrint(allocationReport(steadyAllocations, bytesCopied, job.outputBytes));
+    return true;
+}
+
+// Bytes per block read in encode mode. Blocks need not line up with --lineBytes,
+// separators are placed from each byte's absolute position.
+const size_t ENCODE_BLOCK = CHUNK_SIZE_HEX / 2;
+
+// Encoded conversion: reader, pooled encode and writer stages, the mirror image of convertStreamed
+bool convertEncoded(std::istream& input, std::ostream& output, ThreadPool& pool, ConversionJob& job) {
+    size_t blockBytes = std::min(ENCODE_BLOCK, streamChunkBytes(encodedLength(encodeFormat, 0, 4096, false) / 4096 + 1));
+    ConversionJournal* journal = job.journal;
+    StreamPipeline pipeline(input, output, blockBytes, encodedLength(encodeFormat, 0, blockBytes, false) + 2,
+                            "read -> encode", "encode -> write", journal ? journal->start().inputOffset : 0,
+                            chunkWrittenHook(job, output));
+
+    size_t encodedBytes = journal ? journal->start().outputOffset : 0, consumedInput = 0;
+    long lastPrintedTick = -1;
+    size_t allocationsBefore = heapAllocations, displayAllocations = 0;
+    PipelineChunk* chunk;
+    while (pipeline.readQueue.pop(chunk)) {
+        if (pipeline.aborted) break;
+        char* dest = chunk->out.data();
+        size_t lead = blockLead(encodeFormat, chunk->firstIndex, chunk->inLen == 0, dest);
+        size_t body = bytesToHexParallel(reinterpret_cast<const unsigned char*>(chunk->in.data() + chunk->inStart),
+                                         chunk->inLen, chunk->firstIndex, chunk->last, dest + lead, pool);
+        if (encodeFormat.spaced && !chunk->last && chunk->inLen > 0) body--; // its separator opens the next block
+        chunk->outLen = lead + body;
+        encodedBytes += chunk->outLen;
+        consumedInput += chunk->inputBytes;
+        if (!pipeline.writeQueue.push(chunk)) break;
+
+        // Check if Tab + ESC is pressed to exit
+        if (conversionAborted(job)) {
+            pipeline.abort();
+            pipeline.finish();
+            return false;
+        }
+
+        size_t totalEstimatedBytes = std::max(encodedBytes, encodedLength(encodeFormat, 0, job.inputBytes, true));
+        size_t displayBefore = heapAllocations;
+        if (job.interactive) printConversionStatus(job.startTime, encodedBytes, totalEstimatedBytes, lastPrintedTick);
+        displayAllocations += heapAllocations - displayBefore;
+    }
+    size_t steadyAllocations = heapAllocations - allocationsBefore - displayAllocations;
+    pipeline.finish();
+    job.outputBytes = (journal ? journal->start().outputOffset : 0) + pipeline.writtenBytes;
+
+    if (pipeline.writeFailed) return failJob(job, "Unable to write data in your disk. It may be full or corrupted.");
+    if (pipeline.readFailed) return failJob(job, "Unable to read input file!");
+
+    finishProgress(job);
+
+    pipeline.debugReport();
+    debugPrint(allocationReport(steadyAllocations, 0, job.outputBytes));
+    return true;
+}
+
+// A whole file mapped into memory, either read-only or as a preallocated writable output
+class MappedFile {
+public:
+    MappedFile() = default;
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    ~MappedFile() { close(); }
+
+    bool openRead(const std::string& path) {
+#ifdef _WIN32
+        file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (file == INVALID_HANDLE_VALUE) return false;
+        LARGE_INTEGER fileSize;
+        if (!GetFileSizeEx(file, &fileSize)) return false;
+        length = static_cast<size_t>(fileSize.QuadPart);
+        if (length == 0) return true;
+        mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (!mapping) return false;
+        view = static_cast<char*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+        return view != nullptr;
+#else
+        fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) return false;
+        struct stat st;
+        if (fstat(fd, &st) != 0) return false;
+        length = static_cast<size_t>(st.st_size);
+        if (length == 0) return true;
+        void* addr = mmap(nullptr, length, PROT_READ, MAP_SHARED, fd, 0);
+        if (addr == MAP_FAILED) return false;
+        view = static_cast<char*>(addr);
+        return true;
+#endif
+    }
+
+    // Creates (or truncates) 'path' at exactly 'size' bytes with the disk space reserved up front,
+    // so running out of space is reported here instead of faulting halfway through the decode.
+    // A 'sparse' file is left all holes instead, for callers that skip writing zero blocks.
+    bool createWrite(const std::string& path, size_t size, bool sparse = false) {
+        length = size;
+#ifdef _WIN32
+        file = CreateFileA(path.c_str(), GENERIC_READ | GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (file == INVALID_HANDLE_VALUE) return false;
+        if (length == 0) return true;
+        mapping = CreateFileMappingA(file, nullptr, PAGE_READWRITE,
+                                     static_cast<DWORD>(static_cast<uint64_t>(size) >> 32), static_cast<DWORD>(size & 0xFFFFFFFFu), nullptr);
+        if (!mapping) return false;
+        view = static_cast<char*>(MapViewOfFile(mapping, FILE_MAP_WRITE, 0, 0, size));
+        return view != nullptr;
+#else
+        fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+        if (fd < 0) return false;
+        if (length == 0) return true;
+#ifdef __linux__
+        int err = sparse ? 0 : posix_fallocate(fd, 0, static_cast<off_t>(size));
+        if (err != 0 && err != EOPNOTSUPP && err != EINVAL) return false;
+#endif
+        if (ftruncate(fd, static_cast<off_t>(size)) != 0) return false;
+        void* addr = mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        if (addr == MAP_FAILED) return false;
+        view = static_cast<char*>(addr);
+        return true;
+#endif
+    }
+
+    // Push dirty pages of a writable mapping to disk
+    bool flush() {
+        if (!view) return true;
+#ifdef _WIN32
+        return FlushViewOfFile(view, 0) != 0;
+#else
+        return msync(view, length, MS_SYNC) == 0;
+#endif
+    }
+
+    void close() {
+#ifdef _WIN32
+        if (view) UnmapViewOfFile(view);
+        if (mapping) CloseHandle(mapping);
+        if (file != INVALID_HANDLE_VALUE) CloseHandle(file);
+        mapping = nullptr;
+        file = INVALID_HANDLE_VALUE;
+#else
+        if (view) munmap(view, length);
+        if (fd >= 0) ::close(fd);
+        fd = -1;
+#endif
+        view = nullptr;
+    }
+
+    char* data() const { return view; }
+    size_t size() const { return length; }
+
+private:
+    char* view = nullptr;
+    size_t length = 0;
+#ifdef _WIN32
+    HANDLE file = INVALID_HANDLE_VALUE;
+    HANDLE mapping = nullptr;
+#else
+    int fd = -1;
+#endif
+};
+
+// Memory-mapped conversion: count hex digits per block in parallel, prefix-sum the counts into exact
+// output offsets, then let every block decode straight into its own slice of a mapped output file
+bool convertMapped(ThreadPool& pool, ConversionJob& job) {
+    MappedFile input;
+    if (!input.openRead(job.inputPath)) return failJob(job, "Unable to map input hex file!");
+    const char* text = input.data();
+    size_t textLen = input.size();
+    size_t numBlocks = (textLen + CHUNK_SIZE_HEX - 1) / CHUNK_SIZE_HEX;
+    debugPrint("Mapped input: " + std::to_string(textLen) + " bytes in " + std::to_string(numBlocks) + " blocks");
+
+    // Pass 1: hex digits per block. This is where the mapped pages are first touched, so it counts as the read stage.
+    std::vector<size_t> digitsBefore(numBlocks + 1, 0);
+    auto countBlock = [&](size_t b) {
+        const char* p = text + b * CHUNK_SIZE_HEX;
+        const char* end = text + std::min(textLen, (b + 1) * CHUNK_SIZE_HEX);
+        StageTimer timer(Stage::Read, static_cast<size_t>(end - p));
+        size_t digits = 0;
+        for (; p < end; ++p) digits += !isSpaceChar(*p);
+        digitsBefore[b + 1] = digits;
+    };
+    {
+        TaskGroup group;
+        for (size_t b = 0; b < numBlocks; ++b) {
+            pool.submit(group, [&countBlock, b] { countBlock(b); });
+        }
+        pool.wait(group);
+    }
+    for (size_t b = 0; b < numBlocks; ++b) digitsBefore[b + 1] += digitsBefore[b];
+    size_t totalDigits = digitsBefore[numBlocks];
+    size_t totalBytes = totalDigits / 2;
+
+    MappedFile output;
+    if (!output.createWrite(job.outputPath, totalBytes, sparseOutput)) {
+        return failJob(job, "Unable to write data in your disk. It may be full or corrupted.");
+    }
+    char* out = output.data();
+
+    // Pass 2: each block owns the bytes whose first digit it holds.
+    // A CRC-32C digest is taken per block while the bytes are still in cache and combined in order afterwards.
+    bool blockCrcs = job.digest && job.digest->algorithm() == DigestKind::Crc32c;
+    std::vector<uint32_t> blockCrc(blockCrcs ? numBlocks : 0, 0);
+    std::vector<size_t> blockBytes(blockCrcs ? numBlocks : 0, 0);
+    std::atomic<bool> valid(true), cancelled(false);
+    std::atomic<size_t> decodedBytes(0), bytesCopied(0), holeBytes(0);
+    int danglingChar = -1;
+    auto decodeBlock = [&](size_t b) {
+        if (cancelled || !valid) return;
+        const char* begin = text + b * CHUNK_SIZE_HEX;
+        const char* end = text + std::min(textLen, (b + 1) * CHUNK_SIZE_HEX);
+        size_t blockDigits = digitsBefore[b + 1] - digitsBefore[b];
+        if (blockDigits == 0) return;
+
+        // Dense blocks decode in place; blocks with whitespace are compacted into a scratch buffer first
+        thread_local std::vector<char> scratch;
+        const char* hex = begin;
+        size_t hexLen = blockDigits;
+        if (blockDigits != static_cast<size_t>(end - begin)) {
+            StageTimer timer(Stage::Sanitize, static_cast<size_t>(end - begin));
+            scratch.resize(blockDigits);
+            size_t n = 0;
+            for (const char* p = begin; p < end; ++p) {
+                if (!isSpaceChar(*p)) scratch[n++] = *p;
+            }
+            hex = scratch.data();
+            bytesCopied += blockDigits;
+        }
+        // A leading digit that pairs with the previous block's last one belongs to that block
+        if (digitsBefore[b] % 2 != 0) {
+            hex++;
+            hexLen--;
+        }
+        char* dest = out + (digitsBefore[b] + 1) / 2;
+        size_t pairs = hexLen / 2;
+        StageTimer timer(Stage::Decode, pairs);
+        size_t decoded;
+        if (sparseOutput) {
+            // The fresh output is all holes already; zero blocks are simply never stored
+            thread_local std::vector<char> zeroFlags;
+            zeroFlags.assign(pairs / HOLE_BLOCK + 1, 0);
+            size_t offset = static_cast<size_t>(dest - out);
+            decoded = decodeFindingZeros(hex, pairs, dest, (HOLE_BLOCK - offset % HOLE_BLOCK) % HOLE_BLOCK, zeroFlags.data(), true);
+            holeBytes += static_cast<size_t>(std::count(zeroFlags.begin(), zeroFlags.end(), 1)) * HOLE_BLOCK;
+        } else {
+            decoded = decodeKernel.decode(hex, pairs, dest);
+        }
+        if (decoded != pairs) {
+            valid = false;
+            return;
+        }
+        if (hexLen % 2 != 0) {
+            // Borrow the next digit from whichever later block holds it
+            const char* textEnd = text + textLen;
+            const char* next = end;
+            while (next < textEnd && isSpaceChar(*next)) ++next;
+            if (next == textEnd) {
+                danglingChar = static_cast<unsigned char>(hex[hexLen - 1]);
+            } else {
+                char pair[2] = { hex[hexLen - 1], *next };
+                if (decodeKernel.decode(pair, 1, dest + pairs) != 1) {
+                    valid = false;
+                    return;
+                }
+                pairs++;
+            }
+        }
+        if (blockCrcs) {
+            StageTimer digestTimer(Stage::Digest, pairs);
+            blockCrc[b] = crc32c(0, dest, pairs);
+            blockBytes[b] = pairs;
+        }
+        decodedBytes += pairs;
+    };
+    size_t allocationsBefore = heapAllocations, displayAllocations = 0;
+    TaskGroup group;
+    for (size_t b = 0; b < numBlocks; ++b) {
+        pool.submit(group, [&decodeBlock, b] { decodeBlock(b); });
+    }
+
+    if (!job.interactive) {
+        // Batch jobs run on a worker already; help with the blocks instead of polling
+        pool.wait(group);
+    }
+    long lastPrintedTick = -1;
+    while (!pool.waitFor(group, std::chrono::milliseconds(100))) {
+        if (conversionAborted(job)) {
+            cancelled = true;
+            pool.wait(group);
+            return false;
+        }
+        size_t displayBefore = heapAllocations;
+        printConversionStatus(job.startTime, decodedBytes, totalBytes, lastPrintedTick);
+        displayAllocations += heapAllocations - displayBefore;
+    }
+    size_t steadyAllocations = heapAllocations - allocationsBefore - displayAllocations;
+    if (abortRequested) return false;
+
+    if (!valid || (danglingChar >= 0 && !isHexChar(static_cast<char>(danglingChar)))) {
+        return failInvalidHex(job, false);
+    }
+    if (danglingChar >= 0) return failInvalidHex(job, true);
+    if (blockCrcs) {
+        for (size_t b = 0; b < numBlocks; ++b) job.digest->appendCrc(blockCrc[b], blockBytes[b]);
+    } else if (job.digest) {
+        StageTimer timer(Stage::Digest, totalBytes);
+        job.digest->update(out, totalBytes);
+    }
+    {
+        StageTimer timer(Stage::Write, totalBytes);
+        if (!output.flush()) return failJob(job, "Unable to write data in your disk. It may be full or corrupted.");
+    }
+    job.outputBytes = totalBytes;
+    job.holeBytes = holeBytes;
+
+    finishProgress(job);
+    debugPrint(allocationReport(steadyAllocations, bytesCopied, job.outputBytes));
+    return true;
+}
+
+// Memory-mapped encode: the output size is known up front, so every block is encoded straight into place
+bool convertEncodedMapped(ThreadPool& pool, ConversionJob& job) {
+    MappedFile input;
+    if (!input.openRead(job.inputPath)) return failJob(job, "Unable to map input file!");
+    const unsigned char* in = reinterpret_cast<const unsigned char*>(input.data());
+    size_t n = input.size();
+    size_t totalBytes = encodedLength(encodeFormat, 0, n, true);
+
+    MappedFile output;
+    if (!output.createWrite(job.outputPath, totalBytes)) {
+        return failJob(job, "Unable to write data in your disk. It may be full or corrupted.");
+    }
+    char* out = output.data();
+
+    long lastPrintedTick = -1;
+    size_t encodedBytes = 0;
+    for (size_t first = 0; first < n; first += ENCODE_BLOCK) {
+        size_t count = std::min(ENCODE_BLOCK, n - first);
+        char* dest = out + encodedLength(encodeFormat, 0, first, false);
+        size_t produced = bytesToHexParallel(in + first, count, first, first + count == n, dest, pool);
+        if (job.digest) {
+            StageTimer timer(Stage::Digest, produced);
+            job.digest->update(dest, produced);
+        }
+        encodedBytes += produced;
+        if (conversionAborted(job)) return false;
+        if (job.interactive) printConversionStatus(job.startTime, encodedBytes, totalBytes, lastPrintedTick);
+    }
+
+    {
+        StageTimer timer(Stage::Write, totalBytes);
+        if (!output.flush()) return failJob(job, "Unable to write data in your disk. It may be full or corrupted.");
+    }
+    job.outputBytes = totalBytes;
+    finishProgress(job);
+    return true;
+}
+
+enum class InputFormat { Auto, Hex, IntelHex, SRecord, Xxd, CArray };
+
+InputFormat inputFormat = InputFormat::Auto;
+std::vector<char> fillPattern; // empty = leave gaps between records as holes
+
+const char* inputFormatName(InputFormat format) {
+    switch (format) {
+        case InputFormat::Hex: return "hex";
+        case InputFormat::IntelHex: return "Intel HEX";
+        case InputFormat::SRecord: return "Motorola S-record";
+        case InputFormat::Xxd: return "xxd dump";
+        case InputFormat::CArray: return "C array";
+        default: return "auto";
+    }
+}
+
+// Guess the input format from the first few KB of the file
+InputFormat detectInputFormat(const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    std::string head(4096, '\0');
+    file.read(&head[0], static_cast<std::streamsize>(head.size()));
+    head.resize(static_cast<size_t>(file.gcount()));
+
+    size_t start = 0;
+    while (start < head.size() && isSpaceChar(head[start])) ++start;
+    if (start == head.size()) return InputFormat::Hex;
+    const char* p = head.data() + start;
+    size_t left = head.size() - start;
+
+    if (p[0] == ':') return InputFormat::IntelHex;
+    if ((p[0] == 'S' || p[0] == 's') && left > 1 && p[1] >= '0' && p[1] <= '9') return InputFormat::SRecord;
+
+    // xxd: "00000000: 4c6f 7265 ..."
+    size_t digits = 0;
+    while (digits < left && isHexChar(p[digits])) ++digits;
+    if (digits >= 4 && digits < left && p[digits] == ':') return InputFormat::Xxd;
+
+    if (head.find('{') != std::string::npos && (head.find("0x") != std::string::npos || head.find("0X") != std::string::npos)) {
+        return InputFormat::CArray;
+    }
+    return InputFormat::Hex;
+}
+
+// Sum of bytes modulo 256, which is what Intel HEX and S-record checksums are built on
+unsigned char byteSum(const unsigned char* data, size_t n) {
+    size_t i = 0;
+    uint64_t sum = 0;
+#ifdef __SSE2__
+    __m128i acc = _mm_setzero_si128();
+    for (; i + 16 <= n; i += 16) {
+        acc = _mm_add_epi64(acc, _mm_sad_epu8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i)), _mm_setzero_si128()));
+    }
+    sum = static_cast<uint64_t>(_mm_cvtsi128_si64(acc)) + static_cast<uint64_t>(_mm_cvtsi128_si64(_mm_unpackhi_epi64(acc, acc)));
+#endif
+    for (; i < n; ++i) sum += data[i];
+    return static_cast<unsigned char>(sum);
+}
+
+// Parser state carried from line to line
+struct RecordState {
+    uint64_t addressBase = 0;         // Intel HEX extended segment/linear address
+    uint64_t nextAddress = 0;         // C arrays carry no addresses, bytes simply follow each other
+    bool inArray = false;
+    bool done = false;                // end-of-file record seen, later lines are ignored
+    std::vector<unsigned char> bytes; // decoded record, reused for every line
+};
+
+// Data found on one line
+struct Record {
+    uint64_t address = 0;
+    const unsigned char* data = nullptr;
+    size_t length = 0;
+};
+
+// Decode 'len' hex digits with the vectorized kernel into state.bytes
+bool decodeRecordBytes(const char* hex, size_t len, RecordState& state, std::string& error) {
+    if (len % 2 != 0) {
+        error = "odd number of hex digits";
+        return false;
+    }
+    state.bytes.resize(len / 2);
+    if (decodeKernel.decode(hex, len / 2, reinterpret_cast<char*>(state.bytes.data())) != len / 2) {
+        error = "invalid hex character";
+        return false;
+    }
+    return true;
+}
+
+// ":LLAAAATT<data>CC", all bytes including the checksum sum to zero
+bool parseIntelHexLine(const char* line, size_t len, RecordState& state, Record& record, std::string& error) {
+    if (line[0] != ':') {
+        error = "record does not start with ':'";
+        return false;
+    }
+    if (len < 11) {
+        error = "record too short";
+        return false;
+    }
+    if (!decodeRecordBytes(line + 1, len - 1, state, error)) return false;
+    const unsigned char* b = state.bytes.data();
+    size_t n = state.bytes.size();
+    if (static_cast<size_t>(b[0]) + 5 != n) {
+        error = "byte count does not match record length";
+        return false;
+    }
+    if (byteSum(b, n) != 0) {
+        error = "checksum mismatch";
+        return false;
+    }
+    uint64_t offset = (static_cast<uint64_t>(b[1]) << 8) | b[2];
+    switch (b[3]) {
+        case 0x00: // data
+            record.address = state.addressBase + offset;
+            record.data = b + 4;
+            record.length = b[0];
+            return true;
+        case 0x01: // end of file
+            state.done = true;
+            return true;
+        case 0x02: // extended segment address
+        case 0x04: // extended linear address
+            if (b[0] != 2) {
+                error = "bad extended address record";
+                return false;
+            }
+            state.addressBase = ((static_cast<uint64_t>(b[4]) << 8) | b[5]) << (b[3] == 0x02 ? 4 : 16);
+            return true;
+        case 0x03: // start segment address
+        case 0x05: // start linear address
+            return true;
+        default:
+            error = "unknown record type";
+            return false;
+    }
+}
+
+// "S<type><count><address><data><checksum>", count..data sum to the one's complement of the checksum
+bool parseSRecordLine(const char* line, size_t len, RecordState& state, Record& record, std::string& error) {
+    if ((line[0] != 'S' && line[0] != 's') || len < 4 || line[1] < '0' || line[1] > '9') {
+        error = "record does not start with S0-S9";
+        return false;
+    }
+    int type = line[1] - '0';
+    if (!decodeRecordBytes(line + 2, len - 2, state, error)) return false;
+    const unsigned char* b = state.bytes.data();
+    size_t n = state.bytes.size();
+    if (static_cast<size_t>(b[0]) + 1 != n) {
+        error = "byte count does not match record length";
+        return false;
+    }
+    if (byteSum(b, n) != 0xFF) {
+        error = "checksum mismatch";
+        return false;
+    }
+    size_t addressBytes;
+    switch (type) {
+        case 1: addressBytes = 2; break;
+        case 2: addressBytes = 3; break;
+        case 3: addressBytes = 4; break;
+        case 7: case 8: case 9: // termination
+            state.done = true;
+            return true;
+        case 0: case 5: case 6: // header and record counts
+            return true;
+        default:
+            error = "unknown record type";
+            return false;
+    }
+    if (n < 2 + addressBytes) {
+        error = "record too short";
+        return false;
+    }
+    record.address = 0;
+    for (size_t i = 0; i < addressBytes; ++i) record.address = (record.address << 8) | b[1 + i];
+    record.data = b + 1 + addressBytes;
+    record.length = n - 2 - addressBytes;
+    return true;
+}
+
+// "00000010: 6d20 646f 6c6f  m dolo", the ASCII column starts after two spaces
+bool parseXxdLine(const char* line, size_t len, RecordState& state, Record& record, std::string& error) {
+    size_t colon = 0;
+    uint64_t address = 0;
+    for (; colon < len && line[colon] != ':'; ++colon) {
+        unsigned char v = HEX_TABLE.value[static_cast<unsigned char>(line[colon])];
+        if (v > 0x0F || colon >= 16) {
+            error = "bad offset";
+            return false;
+        }
+        address = (address << 4) | v;
+    }
+    if (colon == len) {
+        error = "missing ':' after offset";
+        return false;
+    }
+    thread_local std::vector<char> digits;
+    digits.clear();
+    size_t i = colon + 1;
+    if (i < len && line[i] == ' ') ++i;
+    for (; i < len; ++i) {
+        if (line[i] == ' ') {
+            if (i + 1 < len && line[i + 1] == ' ') break;
+            continue;
+        }
+        digits.push_back(line[i]);
+    }
+    if (!decodeRecordBytes(digits.data(), digits.size(), state, error)) return false;
+    record.address = address;
+    record.data = state.bytes.data();
+    record.length = state.bytes.size();
+    return true;
+}
+
+// "unsigned char data[] = { 0x4c, 0x6f, ... };" as written by xxd -i
+bool parseCArrayLine(const char* line, size_t len, RecordState& state, Record& record, std::string& error) {
+    state.bytes.clear();
+    for (size_t i = 0; i < len && !state.done; ++i) {
+        if (!state.inArray) {
+            state.inArray = line[i] == '{';
+        } else if (line[i] == '}') {
+            state.done = true;
+        } else if (line[i] == '0' && i + 2 < len && (line[i + 1] == 'x' || line[i + 1] == 'X')) {
+            unsigned int value = 0;
+            size_t digits = 0;
+            for (i += 2; i < len && digits < 2 && HEX_TABLE.value[static_cast<unsigned char>(line[i])] <= 0x0F; ++i, ++digits) {
+                value = (value << 4) | HEX_TABLE.value[static_cast<unsigned char>(line[i])];
+            }
+            if (digits == 0) {
+                error = "'0x' without digits";
+                return false;
+            }
+            state.bytes.push_back(static_cast<unsigned char>(value));
+            --i;
+        }
+    }
+    record.address = state.nextAddress;
+    record.data = state.bytes.data();
+    record.length = state.bytes.size();
+    state.nextAddress += state.bytes.size();
+    return true;
+}
+
+using ParseLineFn = bool (*)(const char* line, size_t len, RecordState& state, Record& record, std::string& error);
+
+ParseLineFn recordParser(InputFormat format) {
+    switch (format) {
+        case InputFormat::IntelHex: return parseIntelHexLine;
+        case InputFormat::SRecord: return parseSRecordLine;
+        case InputFormat::Xxd: return parseXxdLine;
+        case InputFormat::CArray: return parseCArrayLine;
+        default: return nullptr;
+    }
+}
+
+// Data bytes at consecutive addresses
+struct Segment {
+    uint64_t address;
+    std::vector<char> data;
+};
+
+// Write 'length' bytes of the fill pattern at output offset 'offset', keeping the pattern phase tied to the offset
+bool writeFill(std::ostream& output, uint64_t offset, uint64_t length) {
+    thread_local std::vector<char> block;
+    const size_t blockSize = 1024 * 1024;
+    if (block.size() != blockSize + fillPattern.size()) {
+        block.resize(blockSize + fillPattern.size());
+        for (size_t i = 0; i < block.size(); ++i) block[i] = fillPattern[i % fillPattern.size()];
+    }
+    output.seekp(static_cast<std::streamoff>(offset));
+    while (length > 0) {
+        size_t n = static_cast<size_t>(std::min<uint64_t>(length, blockSize));
+        output.write(block.data() + offset % fillPattern.size(), static_cast<std::streamsize>(n));
+        offset += n;
+        length -= n;
+    }
+    return static_cast<bool>(output);
+}
+
+// Record-oriented conversion (Intel HEX, S-record, xxd, C array). Records are decoded and checksummed with
+// the vectorized kernels, merged into segments and written at their address relative to the lowest one.
+// Gaps become holes (seeking past them) unless --fill asks for a pattern.
+bool convertRecords(std::ostream& output, InputFormat format, ConversionJob& job) {
+    MappedFile input;
+    if (!input.openRead(job.inputPath)) return failJob(job, "Unable to map input hex file!");
+    ParseLineFn parseLine = recordParser(format);
+    const char* text = input.data();
+    const char* textEnd = text + input.size();
+
+    RecordState state;
+    std::vector<Segment> segments;
+    std::string error;
+    size_t lineNumber = 0, dataBytes = 0;
+    long lastPrintedTick = -1;
+    // Parsing is where checksums are verified; timed in chunks of 4096 lines
+    StageTimer validate(Stage::Validate, 0);
+    const char* validateFrom = text;
+    for (const char* line = text; line < textEnd && !state.done; ) {
+        const char* next = static_cast<const char*>(std::memchr(line, '\n', static_cast<size_t>(textEnd - line)));
+        const char* lineEnd = next ? next : textEnd;
+        ++lineNumber;
+
+        // Trim surrounding whitespace (CR included)
+        const char* begin = line;
+        while (begin < lineEnd && isSpaceChar(*begin)) ++begin;
+        const char* end = lineEnd;
+        while (end > begin && isSpaceChar(end[-1])) --end;
+        line = next ? next + 1 : textEnd;
+        if (begin == end) continue;
+
+        Record record;
+        if (!parseLine(begin, static_cast<size_t>(end - begin), state, record, error)) {
+            return failJob(job, std::string("Not a valid ") + inputFormatName(format) + " file! (line "
+                                + std::to_string(lineNumber) + ": " + error + ")");
+        }
+        if (record.length > 0) {
+            const char* bytes = reinterpret_cast<const char*>(record.data);
+            if (!segments.empty() && segments.back().address + segments.back().data.size() == record.address) {
+                segments.back().data.insert(segments.back().data.end(), bytes, bytes + record.length);
+            } else {
+                segments.push_back({ record.address, std::vector<char>(bytes, bytes + record.length) });
+            }
+            dataBytes += record.length;
+        }
+
+        if (lineNumber % 4096 == 0) {
+            validate.setBytes(static_cast<size_t>(line - validateFrom));
+            validate.restart(0);
+            validateFrom = line;
+            if (conversionAborted(job)) return false;
+            if (job.interactive) {
+                printConversionStatus(job.startTime, static_cast<size_t>(line - text), input.size(), lastPrintedTick);
+            }
+        }
+    }
+
+    validate.setBytes(static_cast<size_t>(textEnd - validateFrom));
+    validate.stop();
+
+    if (segments.empty()) {
+        job.outputBytes = 0;
+        finishProgress(job);
+        return true;
+    }
+
+    // Positioned writes in record order, so a later record overwrites an earlier one at the same address
+    StageTimer writeTimer(Stage::Write, dataBytes);
+    uint64_t base = segments.front().address, top = 0;
+    for (const Segment& segment : segments) {
+        base = std::min(base, segment.address);
+        top = std::max<uint64_t>(top, segment.address + segment.data.size());
+    }
+    for (const Segment& segment : segments) {
+        output.seekp(static_cast<std::streamoff>(segment.address - base));
+        output.write(segment.data.data(), static_cast<std::streamsize>(segment.data.size()));
+    }
+
+    // Whatever no record covers is a gap
+    std::vector<std::pair<uint64_t, uint64_t>> covered;
+    for (const Segment& segment : segments) covered.push_back({ segment.address, segment.address + segment.data.size() });
+    std::sort(covered.begin(), covered.end());
+    uint64_t gapBytes = 0, cursor = base;
+    for (const auto& range : covered) {
+        if (range.first > cursor) {
+            gapBytes += range.first - cursor;
+            if (!fillPattern.empty() && !writeFill(output, cursor - base, range.first - cursor)) break;
+        }
+        cursor = std::max(cursor, range.second);
+    }
+    output.flush();
+    writeTimer.stop();
+    if (!output) return failJob(job, "Unable to write data in your disk. It may be full or corrupted.");
+    job.outputBytes = static_cast<size_t>(top - base);
+
+    finishProgress(job);
+
+    std::ostringstream summary;
+    summary << std::hex << std::uppercase << std::setfill('0')
+            << "Address range: 0x" << std::setw(8) << base << " - 0x" << std::setw(8) << (top - 1) << std::dec
+            << " (" << segments.size() << " segments, " << formatSize(dataBytes) << " of data, " << formatSize(gapBytes)
+            << (fillPattern.empty() ? " left as holes)" : " filled)");
+    job.summary = summary.str();
+    return true;
+}
+
+// What a journal belongs to: the input file as it was, and every setting that shapes the output
+std::string journalIdentity(const std::string& inputPath) {
+    std::error_code ec;
+    std::ostringstream identity;
+    identity << "hex2file-journal 2\ninput " << std::filesystem::absolute(inputPath, ec).string()
+             << "\nsize " << std::filesystem::file_size(inputPath, ec)
+             << "\nmodified " << std::filesystem::last_write_time(inputPath, ec).time_since_epoch().count() << "\n";
+    if (encodeMode) {
+        identity << "mode encode " << (encodeFormat.spaced ? "spaced " : "dense ") << (encodeFormat.uppercase ? "upper " : "lower ")
+                 << encodeFormat.lineBytes << "\n";
+    } else {
+        identity << "mode decode\n";
+    }
+    return identity.str();
+}
+
+// Feeds the first 'length' bytes of an already written file to the digest: the prefix a resumed run keeps,
+// or a whole record-format output, whose gaps are only settled once every record is placed
+bool digestWrittenFile(OutputDigest& digest, const std::string& path, uint64_t length) {
+    std::ifstream file(path, std::ios::binary);
+    std::vector<char> buffer(1 << 20);
+    while (length > 0 && file) {
+        file.read(buffer.data(), static_cast<std::streamsize>(std::min<uint64_t>(length, buffer.size())));
+        size_t got = static_cast<size_t>(file.gcount());
+        StageTimer timer(Stage::Digest, got);
+        digest.update(buffer.data(), got);
+        length -= got;
+    }
+    return length == 0;
+}
+
+// --incremental: re-converts only what changed since the last run. The input text is cut into content-defined
+// chunks, so an edit moves only the boundaries next to it. <output>.h2findex keeps each chunk's hash and where its
+// bytes went; chunks found there again are not decoded at all. When every reused chunk is still at its old output
+// offset, only the changed ones are written into the existing output; otherwise the output is rebuilt with the
+// reused bytes copied over from the old one.
+bool useIncremental = false;
+
+const size_t CDC_MIN_CHUNK = 16 * 1024;
+const size_t CDC_MAX_CHUNK = 256 * 1024;
+const uint64_t CDC_MASK = 0xFFFF000000000000ull;      // 16 bits: a cut every 64 KB of text on average
+const size_t CDC_SEGMENT = 4 * 1024 * 1024;           // text scanned for cut candidates per task
+const size_t INCREMENTAL_WINDOW = 16 * 1024 * 1024;   // output decoded and written per step
+
+// Gear hash table (xorshift64 from a fixed seed, so boundaries are the same on every machine)
+struct GearTable {
+    uint64_t value[256] = {};
+    constexpr GearTable() {
+        uint64_t state = 0x2545F4914F6CDD1Dull;
+        for (int i = 0; i < 256; ++i) {
+            state ^= state << 13;
+            state ^= state >> 7;
+            state ^= state << 17;
+            value[i] = state;
+        }
+    }
+};
+constexpr GearTable GEAR_TABLE;
+
+struct IncrementalChunk {
+    size_t textStart = 0, textEnd = 0;
+    size_t digits = 0;       // non-whitespace characters
+    int lastDigit = -1;      // the last of them, carried into the next chunk when the count so far is odd
+    int carryIn = -1;        // unpaired digit from the chunks before, decoded as this chunk's first
+    uint64_t textHash = 0;
+    uint64_t key = 0;        // text hash mixed with the carried digit: equal keys decode to equal bytes
+    size_t outStart = 0, outLen = 0;
+    bool reused = false;
+    uint64_t oldOffset = 0;  // where the reused bytes sit in the previous output
+};
+
+// Content-defined cut points of 'text'. The gear hash only depends on the last 64 bytes, so each segment
+// finds its candidates on its own after a 64 byte warm-up; the min/max rules are applied in order afterwards.
+std::vector<size_t> contentDefinedCuts(const char* text, size_t textLen, ThreadPool& pool) {
+    size_t numSegments = (textLen + CDC_SEGMENT - 1) / CDC_SEGMENT;
+    std::vector<std::vector<size_t>> candidates(numSegments);
+    {
+        TaskGroup group;
+        for (size_t s = 0; s < numSegments; ++s) {
+            pool.submit(group, [&, s] {
+                size_t start = s * CDC_SEGMENT, end = std::min(textLen, start + CDC_SEGMENT);
+                StageTimer timer(Stage::Read, end - start);
+                const unsigned char* p = reinterpret_cast<const unsigned char*>(text);
+                uint64_t hash = 0;
+                for (size_t i = start >= 64 ? start - 64 : 0; i < start; ++i) hash = (hash << 1) + GEAR_TABLE.value[p[i]];
+                for (size_t i = start; i < end; ++i) {
+                    hash = (hash << 1) + GEAR_TABLE.value[p[i]];
+                    if ((hash & CDC_MASK) == 0) candidates[s].push_back(i + 1);
+                }
+            });
+        }
+        pool.wait(group);
+    }
+    std::vector<size_t> cuts;
+    size_t last = 0;
+    for (const std::vector<size_t>& segment : candidates) {
+        for (size_t cut : segment) {
+            while (cut - last > CDC_MAX_CHUNK) cuts.push_back(last += CDC_MAX_CHUNK);
+            if (cut - last >= CDC_MIN_CHUNK) cuts.push_back(last = cut);
+        }
+    }
+    while (textLen - last > CDC_MAX_CHUNK) cuts.push_back(last += CDC_MAX_CHUNK);
+    if (textLen > last) cuts.push_back(textLen);
+    return cuts;
+}
+
+std::string incrementalIndexPath(const std::string& outputPath) {
+    return outputPath + ".h2findex";
+}
+
+// Identifies the output an index describes, so an output changed behind our back is never patched
+std::string outputStamp(const std::string& outputPath) {
+    std::error_code ec;
+    uintmax_t size = std::filesystem::file_size(outputPath, ec);
+    if (ec) return "";
+    auto modified = std::filesystem::last_write_time(outputPath, ec).time_since_epoch().count();
+    if (ec) return "";
+    return "output-size " + std::to_string(size) + "\noutput-modified " + std::to_string(modified) + "\n";
+}
+
+// Chunk key -> output offset and length from the last run (plus offset -> key, so repeated content keeps its place), if the index still matches the output
+bool loadIncrementalIndex(const std::string& outputPath, std::unordered_map<uint64_t, std::pair<uint64_t, size_t>>& chunks,
+                          std::unordered_map<uint64_t, uint64_t>& keyAt) {
+    std::ifstream file(incrementalIndexPath(outputPath), std::ios::binary);
+    if (!file.is_open()) return false;
+    std::string stamp = outputStamp(outputPath);
+    std::stringstream contents;
+    contents << file.rdbuf();
+    std::string text = contents.str();
+    std::string header = "hex2file-index 1\n" + stamp;
+    if (stamp.empty() || text.compare(0, header.size(), header) != 0) {
+        debugPrint("Incremental index does not match the output, converting everything");
+        return false;
+    }
+    std::istringstream fields(text.substr(header.size()));
+    std::string tag;
+    uint64_t key, offset;
+    size_t length;
+    while (fields >> tag >> std::hex >> key >> std::dec >> offset >> length) {
+        if (tag != "chunk") continue;
+        chunks.emplace(key, std::make_pair(offset, length));
+        keyAt.emplace(offset, key);
+    }
+    return true;
+}
+
+bool saveIncrementalIndex(const std::string& outputPath, const std::vector<IncrementalChunk>& chunks) {
+    std::string path = incrementalIndexPath(outputPath), partial = path + ".partial";
+    {
+        std::ofstream file(partial, std::ios::binary | std::ios::trunc);
+        file << "hex2file-index 1\n" << outputStamp(outputPath);
+        for (const IncrementalChunk& chunk : chunks) {
+            if (chunk.outLen > 0) file << "chunk " << std::hex << chunk.key << std::dec << " " << chunk.outStart << " " << chunk.outLen << "\n";
+        }
+        if (!file.flush()) return false;
+    }
+    std::error_code ec;
+    std::filesystem::rename(partial, path, ec);
+    return !ec;
+}
+
+bool convertIncremental(ThreadPool& pool, ConversionJob& job) {
+    MappedFile input;
+    if (!input.openRead(job.inputPath)) return failJob(job, "Unable to map input hex file!");
+    const char* text = input.data();
+    size_t textLen = input.size();
+
+    // Chunks, with their digit counts and hashes
+    std::vector<size_t> cuts = contentDefinedCuts(text, textLen, pool);
+    std::vector<IncrementalChunk> chunks(cuts.size());
+    {
+        TaskGroup group;
+        for (size_t c = 0; c < chunks.size(); ++c) {
+            chunks[c].textStart = c == 0 ? 0 : cuts[c - 1];
+            chunks[c].textEnd = cuts[c];
+            pool.submit(group, [&chunks, text, c] {
+                IncrementalChunk& chunk = chunks[c];
+                StageTimer timer(Stage::Read, chunk.textEnd - chunk.textStart);
+                for (size_t i = chunk.textStart; i < chunk.textEnd; ++i) {
+                    if (isSpaceChar(text[i])) continue;
+                    chunk.digits++;
+                    chunk.lastDigit = static_cast<unsigned char>(text[i]);
+                }
+                Xxh3Stream hash;
+                hash.update(text + chunk.textStart, chunk.textEnd - chunk.textStart);
+                chunk.textHash = hash.digest();
+            });
+        }
+        pool.wait(group);
+    }
+    size_t digitsBefore = 0;
+    int carry = -1;
+    for (IncrementalChunk& chunk : chunks) {
+        chunk.carryIn = carry;
+        chunk.key = chunk.textHash ^ (static_cast<uint64_t>(carry + 1) * 0x9E3779B97F4A7C15ull);
+        chunk.outStart = digitsBefore / 2;
+        chunk.outLen = (digitsBefore + chunk.digits) / 2 - chunk.outStart;
+        digitsBefore += chunk.digits;
+        if (chunk.digits > 0) carry = (digitsBefore % 2 != 0) ? chunk.lastDigit : -1;
+    }
+    size_t totalBytes = digitsBefore / 2;
+    if (carry >= 0) {
+        return failInvalidHex(job, isHexChar(static_cast<char>(carry)));
+    }
+
+    // Which chunks the last run already converted, and whether they are still where they were
+    std::unordered_map<uint64_t, std::pair<uint64_t, size_t>> previous;
+    std::unordered_map<uint64_t, uint64_t> keyAt;
+    bool haveIndex = loadIncrementalIndex(job.outputPath, previous, keyAt);
+    bool inPlace = haveIndex;
+    size_t reusedBytes = 0, reusedChunks = 0;
+    for (IncrementalChunk& chunk : chunks) {
+        auto found = previous.find(chunk.key);
+        if (chunk.outLen == 0 || found == previous.end() || found->second.second != chunk.outLen) continue;
+        chunk.reused = true;
+        auto same = keyAt.find(chunk.outStart);
+        chunk.oldOffset = same != keyAt.end() && same->second == chunk.key ? chunk.outStart : found->second.first;
+        inPlace = inPlace && chunk.oldOffset == chunk.outStart;
+        reusedBytes += chunk.outLen;
+        reusedChunks++;
+    }
+    previous.clear();
+    keyAt.clear();
+
+    std::error_code ec;
+    std::string newPath = job.outputPath + ".h2fnew";
+    std::fstream patched;
+    std::ifstream oldOutput;
+    std::ofstream rebuilt;
+    bool indexDropped = false;
+    if (inPlace) {
+        patched.open(job.outputPath, std::ios::binary | std::ios::in | std::ios::out);
+        if (!patched.is_open()) return failJob(job, "Unable to open output file!");
+    } else {
+        if (reusedChunks > 0) oldOutput.open(job.outputPath, std::ios::binary);
+        rebuilt.open(newPath, std::ios::binary | std::ios::trunc);
+        if (!rebuilt.is_open() || (reusedChunks > 0 && !oldOutput.is_open())) return failJob(job, "Unable to open output file!");
+    }
+    debugPrint("Incremental: " + std::to_string(chunks.size()) + " chunks, " + std::to_string(reusedChunks) + " reused, "
+               + (inPlace ? "patching in place" : "rebuilding the output"));
+
+    // Window by window: decode the changed chunks in parallel, then write them (and copy the reused ones when rebuilding)
+    std::vector<char> window(std::min(totalBytes, INCREMENTAL_WINDOW) + CDC_MAX_CHUNK);
+    std::atomic<bool> valid(true);
+    long lastPrintedTick = -1;
+    bool failedWrite = false;
+    for (size_t first = 0; first < chunks.size() && valid && !failedWrite;) {
+        size_t windowStart = chunks[first].outStart, last = first;
+        while (last < chunks.size() && (last == first || chunks[last].outStart + chunks[last].outLen - windowStart <= INCREMENTAL_WINDOW)) ++last;
+
+        TaskGroup group;
+        for (size_t c = first; c < last; ++c) {
+            if (chunks[c].reused || chunks[c].outLen == 0) continue;
+            pool.submit(group, [&, c] {
+                const IncrementalChunk& chunk = chunks[c];
+                StageTimer timer(Stage::Decode, chunk.outLen);
+                thread_local HexDecoder decoder(decodeKernel);
+                decoder.reset();
+                if (chunk.carryIn >= 0) {
+                    char carried = static_cast<char>(chunk.carryIn);
+                    decoder.feed(Span<const char>(&carried, 1));
+                }
+                Span<char> bytes = decoder.feed(Span<const char>(text + chunk.textStart, chunk.textEnd - chunk.textStart));
+                if (decoder.error() || bytes.size() != chunk.outLen) {
+                    valid = false;
+                    return;
+                }
+                std::memcpy(window.data() + (chunk.outStart - windowStart), bytes.data(), bytes.size());
+            });
+        }
+        pool.wait(group);
+        if (!valid) break;
+
+        StageTimer timer(Stage::Write, chunks[last - 1].outStart + chunks[last - 1].outLen - windowStart);
+        for (size_t c = first; c < last; ++c) {
+            const IncrementalChunk& chunk = chunks[c];
+            char* bytes = window.data() + (chunk.outStart - windowStart);
+            if (inPlace) {
+                if (chunk.reused || chunk.outLen == 0) continue;
+                // A patch in progress invalidates the index; it is written again once the output is complete
+                if (!indexDropped) {
+                    std::filesystem::remove(incrementalIndexPath(job.outputPath), ec);
+                    indexDropped = true;
+                }
+                patched.seekp(static_cast<std::streamoff>(chunk.outStart));
+                patched.write(bytes, static_cast<std::streamsize>(chunk.outLen));
+            } else if (chunk.reused) {
+                oldOutput.seekg(static_cast<std::streamoff>(chunk.oldOffset));
+                oldOutput.read(bytes, static_cast<std::streamsize>(chunk.outLen));
+                if (static_cast<size_t>(oldOutput.gcount()) != chunk.outLen) failedWrite = true;
+            }
+        }
+        if (!inPlace) rebuilt.write(window.data(), static_cast<std::streamsize>(chunks[last - 1].outStart + chunks[last - 1].outLen - windowStart));
+        failedWrite = failedWrite || (inPlace ? !patched : !rebuilt);
+        timer.stop();
+
+        first = last;
+        if (conversionAborted(job)) break;
+        if (job.interactive) printConversionStatus(job.startTime, chunks[last - 1].outStart + chunks[last - 1].outLen, totalBytes, lastPrintedTick);
+    }
+
+    bool complete = valid && !failedWrite && !abortRequested;
+    if (inPlace) {
+        patched.close();
+        if (complete) std::filesystem::resize_file(job.outputPath, totalBytes, ec);
+    } else {
+        rebuilt.close();
+        oldOutput.close();
+        if (complete && !rebuilt.fail()) std::filesystem::rename(newPath, job.outputPath, ec);
+        else std::filesystem::remove(newPath, ec);
+    }
+    if (!valid) return failInvalidHex(job, false);
+    if (abortRequested) return false;
+    if (failedWrite || ec) return failJob(job, "Unable to write data in your disk. It may be full or corrupted.");
+
+    job.outputBytes = totalBytes;
+    if (job.digest && !digestWrittenFile(*job.digest, job.outputPath, totalBytes)) {
+        return failJob(job, "Unable to read back the output file for --digest!");
+    }
+    if (!saveIncrementalIndex(job.outputPath, chunks)) debugPrint("Unable to write the incremental index");
+    finishProgress(job);
+
+    std::ostringstream summary;
+    summary << "Incremental: reused " << formatSize(reusedBytes) << " (" << std::fixed << std::setprecision(1)
+            << 100.0 * static_cast<double>(reusedBytes) / static_cast<double>(std::max<size_t>(totalBytes, 1)) << "%), reconverted "
+            << formatSize(totalBytes - reusedBytes) << " in " << (chunks.size() - reusedChunks) << " of " << chunks.size() << " chunks"
+            << (haveIndex ? (inPlace ? ", patched in place" : ", output rebuilt") : ", index created");
+    job.summary = summary.str();
+    return true;
+}
+
+// The parallel converters only learn that some block was bad. One sequential HexDecoder pass over the
+// input pins down the first bad character, which is cheap next to a conversion and only runs on failure.
+DecodeError findHexError(const std::string& inputPath) {
+    std::ifstream file(inputPath, std::ios::binary);
+    HexDecoder decoder(decodeKernel);
+    std::vector<char> text(1 << 20), out(HexDecoder::decodedCapacity(text.size()));
+    while (file && !decoder.error()) {
+        file.read(text.data(), static_cast<std::streamsize>(text.size()));
+        decoder.feed(Span<const char>(text.data(), static_cast<size_t>(file.gcount())), Span<char>(out));
+    }
+    decoder.finish();
+    return decoder.error();
+}
+
+// Picks the converter for one job
+bool convertFile(ConversionJob& job, ThreadPool& pool) {
+    try {
+        job.inputBytes = static_cast<size_t>(std::filesystem::file_size(job.inputPath));
+    } catch (const std::exception&) {
+        job.inputBytes = 0;
+    }
+
+    InputFormat format = (encodeMode || (inputFormat == InputFormat::Auto && isStdioPath(job.inputPath))) ? InputFormat::Hex : inputFormat;
+    if (format == InputFormat::Auto) {
+        format = detectInputFormat(job.inputPath);
+        debugPrint(std::string("Detected input format: ") + inputFormatName(format));
+    }
+    if (format != InputFormat::Hex && isStdioPath(job.outputPath)) {
+        return failJob(job, "Record formats need a real output file, gaps are written with seeks!");
+    }
+    if (useJournal && (job.mapped || format != InputFormat::Hex)) {
+        return failJob(job, "--journal and --resume only apply to streamed hex conversions, not --mmap or record formats!");
+    }
+    if (useIncremental && format != InputFormat::Hex) {
+        return failJob(job, "--incremental only applies to plain hex input, not record formats!");
+    }
+    job.startTime = std::chrono::steady_clock::now();
+    OutputDigest digest(job.digestKind);
+    if (job.digestKind != DigestKind::None) job.digest = &digest;
+    if (encodeMode && job.mapped) {
+        job.ok = convertEncodedMapped(pool, job);
+    } else if (format != InputFormat::Hex && !encodeMode) {
+        std::ofstream output(job.outputPath, std::ios::binary);
+        job.ok = output.is_open() ? convertRecords(output, format, job) : failJob(job, "Unable to open output file!");
+        output.close();
+        if (job.ok && job.digest && !digestWrittenFile(digest, job.outputPath, job.outputBytes)) {
+            job.ok = failJob(job, "Unable to read back the output file for --digest!");
+        }
+    } else if (useIncremental) {
+        job.ok = convertIncremental(pool, job);
+    } else if (job.mapped) {
+        job.ok = convertMapped(pool, job);
+    } else {
+        std::unique_ptr<ConversionJournal> journal;
+        if (useJournal) {
+            journal.reset(new ConversionJournal(job.outputPath, journalIdentity(job.inputPath)));
+            if (resumeMode && !journal->resume(job.error)) {
+                job.digest = nullptr;
+                return false;
+            }
+            job.journal = journal.get();
+            if (job.digest && !digestWrittenFile(digest, job.outputPath, journal->start().outputOffset)) {
+                job.digest = nullptr;
+                return failJob(job, "Unable to read back the resumed output for --digest!");
+            }
+        }
+
+        std::ifstream inputFile;
+        std::ofstream outputFile;
+        FdStreamBuf stdinBuffer(0), stdoutBuffer(1);
+        std::istream stdinStream(&stdinBuffer);
+        std::ostream stdoutStream(&stdoutBuffer);
+        std::istream* input = &inputFile;
+        std::ostream* output = &outputFile;
+        bool inputOpen = true, outputOpen = true;
+        // --io=posix|uring read and write the files through FileIoBuf instead of the fstreams
+        bool useBackend = ioBackend != IoBackend::Stream;
+#ifndef _WIN32
+        FileIoBuf inputBuffer, outputBuffer;
+        std::istream backendInput(&inputBuffer);
+        std::ostream backendOutput(&outputBuffer);
+#endif
+
+        if (isStdioPath(job.inputPath)) {
+            input = &stdinStream;
+        } else if (useBackend) {
+#ifndef _WIN32
+            input = &backendInput;
+            inputOpen = inputBuffer.openRead(job.inputPath);
+            debugPrint("Input I/O: " + inputBuffer.describe());
+#endif
+        } else {
+            inputFile.open(job.inputPath, std::ios::binary);
+            inputOpen = inputFile.is_open();
+        }
+        if (isStdioPath(job.outputPath)) {
+            output = &stdoutStream;
+        } else if (useBackend) {
+#ifndef _WIN32
+            output = &backendOutput;
+            outputOpen = outputBuffer.openWrite(job.outputPath, resumeMode);
+            debugPrint("Output I/O: " + outputBuffer.describe());
+#endif
+        } else {
+            outputFile.open(job.outputPath, resumeMode ? std::ios::binary | std::ios::in | std::ios::out : std::ios::binary);
+            outputOpen = outputFile.is_open();
+        }
+        // A resumed output keeps the prefix the journal vouched for
+        if (resumeMode && outputOpen) output->seekp(0, std::ios::end);
+        if (journal && inputOpen) input->seekg(static_cast<std::streamoff>(journal->start().inputOffset));
+
+        if (!inputOpen) {
+            job.ok = failJob(job, "Unable to open input hex file!");
+        } else if (!outputOpen) {
+            job.ok = failJob(job, "Unable to open output file!");
+        } else if (journal && !resumeMode && !journal->begin()) {
+            job.ok = failJob(job, "Unable to write the journal! (" + journal->path() + ")");
+        } else {
+            job.ok = encodeMode ? convertEncoded(*input, *output, pool, job) : convertStreamed(*input, *output, pool, job);
+            if (journal) journal->finish(*output, job.ok);
+#ifndef _WIN32
+            if (useBackend && !isStdioPath(job.outputPath) && !outputBuffer.close() && job.ok) {
+                job.ok = failJob(job, "Unable to write data in your disk. It may be full or corrupted.");
+            }
+#endif
+        }
+        job.journal = nullptr;
+    }
+    if (job.ok && job.digest) job.digestHex = digest.hex();
+    job.digest = nullptr;
+    if (job.invalidHex && !isStdioPath(job.inputPath)) {
+        DecodeError where = findHexError(job.inputPath);
+        if (where) job.error += " (" + where.message() + ")";
+    }
+    job.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - job.startTime).count();
+    return job.ok;
+}
+
+// With --expect the output is written under a temporary name and only renamed into place once its digest matched
+std::string stagedOutputPath(const std::string& outputPath) {
+    return (expectedDigest.empty() || isStdioPath(outputPath)) ? outputPath : outputPath + ".partial";
+}
+
+// "12.00 MB (37.5%)": how much of the output --sparse left as holes
+std::string holeReport(const ConversionJob& job) {
+    std::ostringstream text;
+    text << formatSize(job.holeBytes) << " (" << std::fixed << std::setprecision(1)
+         << 100.0 * static_cast<double>(job.holeBytes) / static_cast<double>(std::max<size_t>(job.outputBytes, 1)) << "%)";
+    return text.str();
+}
+
+bool processFile(const std::string& inputPath, const std::string& finalOutputPath) {
+    const std::string outputPath = stagedOutputPath(finalOutputPath);
+    if (!isStdioPath(inputPath)) {
+        debugPrint("Checking if input file exists: " + inputPath);
+        if (!std::filesystem::exists(inputPath)) {
+            std::cerr << "[ERROR]: " << (encodeMode ? "Input" : "Hex") << " file not found! (" << inputPath << ")" << std::endl;
+            return false;
+        }
+
+        if (!std::ifstream(inputPath, std::ios::binary).is_open()) {
+            std::cerr << "[ERROR]: Unable to open input hex file!" << std::endl;
+            return false;
+        }
+        debugPrint("Input hex file opened: " + inputPath);
+    }
+
+    if (!isStdioPath(outputPath)) {
+        if (resumeMode && !std::filesystem::exists(outputPath)) {
+            std::cerr << "[ERROR]: Nothing to resume, the output file does not exist! (" << outputPath << ")" << std::endl;
+            return false;
+        }
+        // A resumed or incremental output is reused, so it must not be truncated here
+        bool keepOutput = resumeMode || (useIncremental && std::filesystem::exists(outputPath));
+        if (!std::ofstream(outputPath, keepOutput ? std::ios::binary | std::ios::in | std::ios::out : std::ios::binary).is_open()) {
+            std::cerr << "[ERROR]: Unable to open output file!" << std::endl;
+            return false;
+        }
+        debugPrint("Output file opened: " + outputPath);
+    }
+    
+    // Debug storage info (nothing to query when writing to a pipe)
+    if (!isStdioPath(outputPath)) {
+        try {
+            std::filesystem::space_info space = std::filesystem::space(outputPath);
+
+            double available = static_cast<double>(space.available);
+            double free = static_cast<double>(space.free);
+            double capacity = static_cast<double>(space.capacity);
+
+            std::ostringstream stream;
+            stream << std::fixed << std::setprecision(2);
+
+            // Print available, free, and total capacity disk space
+            if (available >= 1024.0 * 1024.0 * 1024.0) {
+                stream << "Disk space available: " 
+                    << (available / (1024.0 * 1024.0 * 1024.0)) << " GB\n"
+                    << "[DEBUG]: Disk space free: " 
+                    << (free / (1024.0 * 1024.0 * 1024.0)) << " GB\n"
+                    << "[DEBUG]: Disk space capacity: " 
+                    << (capacity / (1024.0 * 1024.0 * 1024.0)) << " GB";
+            } else {
+                stream << "Disk space available: " 
+                    << (available / (1024.0 * 1024.0)) << " MB\n"
+                    << "[DEBUG]: Disk space free: " 
+                    << (free / (1024.0 * 1024.0)) << " MB\n"
+                    << "[DEBUG]: Disk space capacity: " 
+                    << (capacity / (1024.0 * 1024.0 * 1024.0)) << " GB";
+            }
+            debugPrint(stream.str());
+        } catch (const std::exception& e) {
+            debugPrint(std::string("Failed to get disk space info: ") + e.what());
+        }
+    }
+
+    std::cout << "Starting to Convert file..." << std::endl;
+    std::cout << "Press Tab + ESC to exit when you're tired enough.\n" << std::endl;
+
+    // Display Total Number of CPU Cores
+    unsigned int numCores = std::thread::hardware_concurrency();
+    if (numCores < 1) numCores = 2;
+    std::cout << "Total Number of CPU Cores: " << numCores << std::endl;
+
+    // Worker threads live for the whole conversion instead of being spawned per chunk
+    ThreadPool pool(requestedThreads > 0 ? requestedThreads : numCores);
+    debugPrint("Worker threads: " + std::to_string(pool.size()));
+    debugPrint(std::string(encodeMode ? "Encode kernel: " : "Decode kernel: ") + (encodeMode ? encodeKernel.name : decodeKernel.name));
+
+    ConversionJob job;
+    job.inputPath = inputPath;
+    job.outputPath = outputPath;
+    job.mapped = useMemoryMap;
+    job.digestKind = digestKind;
+    if (!convertFile(job, pool)) {
+        if (!job.error.empty()) std::cerr << "[ERROR]: " << job.error << std::endl;
+        // An unverified staged output is useless unless a journal can pick it up again
+        std::error_code ec;
+        if (outputPath != finalOutputPath && !useJournal) std::filesystem::remove(outputPath, ec);
+        return false;
+    }
+    if (!job.summary.empty()) std::cout << job.summary << std::endl;
+    if (job.holeBytes > 0) std::cout << "Written as holes: " << holeReport(job) << std::endl;
+    if (!job.digestHex.empty()) std::cout << "Digest (" << digestName(job.digestKind) << "): " << job.digestHex << std::endl;
+    if (!expectedDigest.empty()) {
+        std::error_code ec;
+        if (job.digestHex != expectedDigest) {
+            if (outputPath != finalOutputPath) std::filesystem::remove(outputPath, ec);
+            std::cerr << "[ERROR]: Output does not match --expect! (expected " << expectedDigest << ", got " << job.digestHex << ")" << std::endl;
+            return false;
+        }
+        if (outputPath != finalOutputPath) {
+            std::filesystem::rename(outputPath, finalOutputPath, ec);
+            if (ec) {
+                std::cerr << "[ERROR]: Unable to move the verified output into place! (" << ec.message() << ")" << std::endl;
+                return false;
+            }
+        }
+    }
+    size_t writtenBytes = job.outputBytes;
+
+    // FINAL TIME REPORT - NEW
+    auto totalElapsed = static_cast<long long>(job.seconds);
+
+    int thrs = static_cast<int>(totalElapsed / 3600);
+    int tmins = static_cast<int>((totalElapsed % 3600) / 60);
+    int tsecs = static_cast<int>(totalElapsed % 60);
+
+    std::cout << "Conversion Elapsed: "
+            << std::setw(2) << std::setfill('0') << thrs << ":"
+            << std::setw(2) << std::setfill('0') << tmins << ":"
+            << std::setw(2) << std::setfill('0') << tsecs << std::endl;
+
+    double totalBytesPerSec = (job.seconds > 0) ? static_cast<double>(writtenBytes) / job.seconds : 0.0;
+
+    // Show Data Transfer rate speed
+    std::cout << "Data Transfer rate speed: ";
+    if (totalBytesPerSec >= 1024.0 * 1024.0 * 1024.0) {
+        std::cout << std::fixed << std::setprecision(2)
+                << (totalBytesPerSec / (1024.0 * 1024.0 * 1024.0)) << " GB/s" << std::endl;
+    } else if (totalBytesPerSec >= 1024.0 * 1024.0) {
+        std::cout << std::fixed << std::setprecision(2)
+                << (totalBytesPerSec / (1024.0 * 1024.0)) << " MB/s" << std::endl;
+    } else if (totalBytesPerSec >= 1024.0) {
+        std::cout << std::fixed << std::setprecision(2)
+                << (totalBytesPerSec / 1024.0) << " KB/s" << std::endl;
+    } else {
+        std::cout << std::fixed << std::setprecision(2)
+                << totalBytesPerSec << " B/s" << std::endl;
+    }
+    std::cout << "Conversion successful! Output written to " << (isStdioPath(finalOutputPath) ? "standard output" : finalOutputPath) << std::endl;
+    debugPrint("Final written byte count: " + std::to_string(writtenBytes));
+    return writeStatsReport(static_cast<uint64_t>(job.seconds * 1e9), job.inputBytes, job.outputBytes);
+}
+
+// Batch manifest: one "<input> <output>" pair per line, paths with spaces in double quotes,
+// blank lines and lines starting with '#' are skipped
+bool readManifest(const std::string& path, std::vector<std::pair<std::string, std::string>>& pairs, std::string& error) {
+    std::ifstream manifest(path);
+    if (!manifest.is_open()) {
+        error = "Unable to open batch manifest! (" + path + ")";
+        return false;
+    }
+    std::string line;
+    size_t lineNumber = 0;
+    while (std::getline(manifest, line)) {
+        ++lineNumber;
+        std::vector<std::string> fields;
+        size_t pos = 0;
+        while (true) {
+            while (pos < line.size() && isSpaceChar(line[pos])) ++pos;
+            if (pos == line.size() || line[pos] == '#') break;
+            size_t end;
+            if (line[pos] == '"') {
+                end = line.find('"', pos + 1);
+                if (end == std::string::npos) {
+                    error = "Unterminated quote in batch manifest (line " + std::to_string(lineNumber) + ")";
+                    return false;
+                }
+                fields.push_back(line.substr(pos + 1, end - pos - 1));
+                pos = end + 1;
+            } else {
+                end = pos;
+                while (end < line.size() && !isSpaceChar(line[end])) ++end;
+                fields.push_back(line.substr(pos, end - pos));
+                pos = end;
+            }
+        }
+        if (fields.empty()) continue;
+        if (fields.size() != 2 || fields[0].empty() || fields[1].empty()) {
+            error = "Expected \"<input> <output>\" in batch manifest (line " + std::to_string(lineNumber) + ")";
+            return false;
+        }
+        pairs.push_back({ fields[0], fields[1] });
+    }
+    return true;
+}
+
+// Runs every pair as a job on one shared pool, so small files overlap instead of each
+// getting the whole machine in turn, then prints one line per file and the totals
+bool processBatch(const std::vector<std::pair<std::string, std::string>>& pairs) {
+    unsigned int numCores = std::thread::hardware_concurrency();
+    if (numCores < 1) numCores = 2;
+    ThreadPool pool(requestedThreads > 0 ? requestedThreads : numCores);
+
+    std::cout << "Starting to Convert " << pairs.size() << " files..." << std::endl;
+    std::cout << "Press Tab + ESC to exit when you're tired enough.\n" << std::endl;
+    std::cout << "Total Number of CPU Cores: " << numCores << std::endl;
+    debugPrint("Worker threads: " + std::to_string(pool.size()));
+
+    std::vector<ConversionJob> jobs(pairs.size());
+    size_t totalInput = 0;
+    for (size_t i = 0; i < pairs.size(); ++i) {
+        jobs[i].inputPath = pairs[i].first;
+        jobs[i].outputPath = pairs[i].second;
+        jobs[i].interactive = false;
+        jobs[i].digestKind = digestKind;
+        // Pool-only paths: the streamed ones park extra threads on blocking I/O that a shared pool cannot spare
+        jobs[i].mapped = true;
+        std::error_code ec;
+        auto size = std::filesystem::file_size(jobs[i].inputPath, ec);
+        if (!ec) totalInput += static_cast<size_t>(size);
+    }
+
+    auto startTime = std::chrono::steady_clock::now();
+    std::atomic<size_t> doneInput(0);
+    TaskGroup group;
+    for (ConversionJob& job : jobs) {
+        pool.submitJob(group, [&job, &pool, &doneInput] {
+            if (abortRequested) {
+                job.error = "Skipped after Tab + ESC";
+            } else if (!std::filesystem::exists(job.inputPath)) {
+                job.error = std::string(encodeMode ? "Input" : "Hex") + " file not found!";
+            } else {
+                convertFile(job, pool);
+            }
+            doneInput += job.inputBytes;
+        });
+    }
+
+    long lastPrintedTick = -1;
+    while (!pool.waitFor(group, std::chrono::milliseconds(100))) {
+        if (!abortRequested && checkTabEscExit()) {
+            abortRequested = true;
+            std::cout << "\nExiting conversion as requested by user (Tab + ESC).\n" << std::endl;
+        }
+        if (!abortRequested) printConversionStatus(startTime, doneInput, totalInput, lastPrintedTick);
+    }
+    if (!abortRequested) {
+        printProgress(totalInput, totalInput);
+        std::cout << std::endl;
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+
+    size_t failures = 0, inputBytes = 0, outputBytes = 0;
+    for (const ConversionJob& job : jobs) {
+        if (job.ok) {
+            std::cout << "[OK] " << job.inputPath << " -> " << job.outputPath << ": " << formatSize(job.outputBytes)
+                      << " in " << std::fixed << std::setprecision(2) << job.seconds << "s" << std::endl;
+            if (!job.summary.empty()) std::cout << "     " << job.summary << std::endl;
+            if (job.holeBytes > 0) std::cout << "     Written as holes: " << holeReport(job) << std::endl;
+            if (!job.digestHex.empty()) std::cout << "     Digest (" << digestName(job.digestKind) << "): " << job.digestHex << std::endl;
+            inputBytes += job.inputBytes;
+            outputBytes += job.outputBytes;
+        } else {
+            ++failures;
+            std::cout << "[FAILED] " << job.inputPath << ": " << (job.error.empty() ? "Stopped by user" : job.error) << std::endl;
+        }
+    }
+
+    double bytesPerSec = seconds > 0 ? outputBytes / seconds : 0.0;
+    std::cout << "Batch finished: " << (jobs.size() - failures) << " of " << jobs.size() << " files converted"
+              << (failures ? ", " + std::to_string(failures) + " failed" : std::string()) << ", "
+              << formatSize(inputBytes) << " in, " << formatSize(outputBytes) << " out, "
+              << std::fixed << std::setprecision(2) << seconds << "s, "
+              << formatSize(static_cast<size_t>(bytesPerSec)) << "/s" << std::endl;
+    bool statsWritten = writeStatsReport(static_cast<uint64_t>(seconds * 1e9), inputBytes, outputBytes);
+    return failures == 0 && statsWritten;
+}
+
+#ifndef _WIN32
+// Conversion daemon (--serve) and its client (--client). Jobs arrive over a Unix domain socket, one per line:
+//   convert <TAB> <input> <TAB> <output> [<TAB> digest=<algorithm>]
+// Paths are absolute. An input of "-" stands for the file descriptor sent along with that line (SCM_RIGHTS),
+// which must be a regular file. "stop" makes the daemon finish the jobs it has and exit. Each job is answered
+// with one JSON line of stats, in the order the jobs finish; the connection closes once all are answered.
+const size_t SERVE_MAX_LINE = 64 * 1024;
+
+bool unixSocketAddress(const std::string& path, sockaddr_un& address) {
+    std::memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    if (path.empty() || path.size() >= sizeof(address.sun_path)) return false;
+    std::memcpy(address.sun_path, path.c_str(), path.size() + 1);
+    return true;
+}
+
+// Sends all of 'text', with 'fd' attached to its first byte unless it is -1
+bool sendAll(int socketFd, const std::string& text, int fd = -1) {
+    size_t sent = 0;
+    while (sent < text.size()) {
+        iovec part = { const_cast<char*>(text.data() + sent), text.size() - sent };
+        msghdr message = {};
+        message.msg_iov = &part;
+        message.msg_iovlen = 1;
+        alignas(cmsghdr) char control[CMSG_SPACE(sizeof(int))];
+        if (fd >= 0 && sent == 0) {
+            message.msg_control = control;
+            message.msg_controllen = sizeof(control);
+            cmsghdr* header = CMSG_FIRSTHDR(&message);
+            header->cmsg_level = SOL_SOCKET;
+            header->cmsg_type = SCM_RIGHTS;
+            header->cmsg_len = CMSG_LEN(sizeof(int));
+            std::memcpy(CMSG_DATA(header), &fd, sizeof(int));
+        }
+        ssize_t n = sendmsg(socketFd, &message, 0);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        sent += static_cast<size_t>(n);
+    }
+    return true;
+}
+
+// Reads a socket line by line and keeps the file descriptors that come along, oldest first
+class SocketLineReader {
+public:
+    explicit SocketLineReader(int fd) : fd(fd) {}
+
+    ~SocketLineReader() {
+        while (!fds.empty()) close(fds.pop_front());
+    }
+
+    // False at the end of the stream, on an error or on a line longer than SERVE_MAX_LINE
+    bool next(std::string& line) {
+        while (true) {
+            size_t end = buffer.find('\n');
+            if (end != std::string::npos) {
+                line = buffer.substr(0, end);
+                buffer.erase(0, end + 1);
+                if (!line.empty() && line.back() == '\r') line.pop_back();
+                return true;
+            }
+            if (buffer.size() > SERVE_MAX_LINE) return false;
+            char data[4096];
+            iovec part = { data, sizeof(data) };
+            alignas(cmsghdr) char control[CMSG_SPACE(4 * sizeof(int))];
+            msghdr message = {};
+            message.msg_iov = &part;
+            message.msg_iovlen = 1;
+            message.msg_control = control;
+            message.msg_controllen = sizeof(control);
+            int flags = 0;
+#ifdef MSG_CMSG_CLOEXEC
+            flags = MSG_CMSG_CLOEXEC;
+#endif
+            ssize_t n = recvmsg(fd, &message, flags);
+            if (n < 0 && errno == EINTR) continue;
+            if (n <= 0) return false;
+            for (cmsghdr* header = CMSG_FIRSTHDR(&message); header; header = CMSG_NXTHDR(&message, header)) {
+                if (header->cmsg_level != SOL_SOCKET || header->cmsg_type != SCM_RIGHTS) continue;
+                size_t count = (header->cmsg_len - CMSG_LEN(0)) / sizeof(int);
+                for (size_t i = 0; i < count; ++i) {
+                    int received;
+                    std::memcpy(&received, CMSG_DATA(header) + i * sizeof(int), sizeof(int));
+                    fds.push_back(received);
+                }
+            }
+            buffer.append(data, static_cast<size_t>(n));
+        }
+    }
+
+    // The caller owns the descriptor from now on; -1 when none is left
+    int takeFd() { return fds.empty() ? -1 : fds.pop_front(); }
+
+private:
+    int fd;
+    std::string buffer;
+    RingBuffer<int> fds{4};
+};
+
+// Reads one field of a flat JSON object written by jsonString() and friends; empty when it is missing or null
+std::string jsonField(const std::string& object, const std::string& key) {
+    std::string marker = "\"" + key + "\":";
+    size_t pos = object.find(marker);
+    if (pos == std::string::npos) return "";
+    pos += marker.size();
+    if (pos >= object.size() || object[pos] != '"') {
+        std::string value = object.substr(pos, object.find_first_of(",}", pos) - pos);
+        return value == "null" ? "" : value;
+    }
+    std::string value;
+    for (++pos; pos < object.size() && object[pos] != '"'; ++pos) {
+        if (object[pos] == '\\' && pos + 1 < object.size()) {
+            if (object[++pos] == 'u' && pos + 4 < object.size()) {
+                value += static_cast<char>(std::stoi(object.substr(pos + 1, 4), nullptr, 16));
+                pos += 4;
+                continue;
+            }
+        }
+        value += object[pos];
+    }
+    return value;
+}
+
+// Hands queued jobs to the pool, at most one per worker at a time, taking turns between connections
+// so a client with a thousand files cannot hold up one with a single file
+class FairScheduler {
+public:
+    explicit FairScheduler(ThreadPool& pool) : pool(pool) {}
+
+    void add(uint64_t client, std::function<void()> job) {
+        std::lock_guard<std::mutex> guard(lock);
+        queued.emplace(client, RingBuffer<std::function<void()>>(8)).first->second.push_back(std::move(job));
+        admit();
+    }
+
+    // Waits for every job added so far, helping with their tasks meanwhile
+    void drain() { pool.wait(group); }
+
+private:
+    ThreadPool& pool;
+    std::mutex lock;
+    std::map<uint64_t, RingBuffer<std::function<void()>>> queued; // per connection, in arrival order
+    uint64_t lastClient = 0;
+    size_t active = 0;
+    TaskGroup group;
+
+    // Caller holds 'lock'
+    void admit() {
+        while (active < pool.size() && !queued.empty()) {
+            auto next = queued.upper_bound(lastClient);
+            if (next == queued.end()) next = queued.begin();
+            lastClient = next->first;
+            std::function<void()> job = next->second.pop_front();
+            if (next->second.empty()) queued.erase(next);
+            active++;
+            pool.submitJob(group, [this, job] {
+                job();
+                std::lock_guard<std::mutex> guard(lock);
+                active--;
+                admit();
+            });
+        }
+    }
+};
+
+// One client connection. Its reader thread queues the jobs; pool workers send the replies.
+struct ServeConnection {
+    int fd = -1;
+    uint64_t id = 0;
+    std::mutex lock;
+    std::condition_variable idle;
+    size_t pending = 0;          // jobs queued or running, guarded by 'lock'
+    std::atomic<bool> finished{false};
+    std::thread reader;
+
+    void reply(const std::string& json) {
+        std::lock_guard<std::mutex> guard(lock);
+        sendAll(fd, json + "\n");
+    }
+};
+
+struct ServeJob {
+    ConversionJob job;
+    size_t number = 0;           // position in its connection
+    int inputFd = -1;            // descriptor passed with input "-", closed once converted
+    std::string inputName;       // as the client gave it
+    std::chrono::steady_clock::time_point received;
+    double queuedSeconds = 0.0;
+};
+
+std::string serveReport(const ServeJob& request) {
+    const ConversionJob& job = request.job;
+    std::ostringstream json;
+    json << std::setprecision(6) << "{\"job\":" << request.number << ",\"ok\":" << (job.ok ? "true" : "false")
+         << ",\"input\":" << jsonString(request.inputName) << ",\"output\":" << jsonString(job.outputPath)
+         << ",\"inputBytes\":" << job.inputBytes << ",\"outputBytes\":" << job.outputBytes << ",\"holeBytes\":" << job.holeBytes
+         << ",\"queuedSeconds\":" << request.queuedSeconds << ",\"seconds\":" << job.seconds
+         << ",\"gbps\":" << (job.ok && job.seconds > 0 ? job.outputBytes / job.seconds / 1e9 : 0.0)
+         << ",\"digestAlgorithm\":" << (job.digestHex.empty() ? "null" : jsonString(digestName(job.digestKind)))
+         << ",\"digest\":" << (job.digestHex.empty() ? "null" : jsonString(job.digestHex))
+         << ",\"error\":" << (job.ok ? "null" : jsonString(job.error.empty() ? "Stopped" : job.error)) << "}";
+    return json.str();
+}
+
+std::atomic<bool> serveStopRequested{false};
+
+void requestServeStop(int) {
+    serveStopRequested = true;
+}
+
+struct ServeTotals {
+    std::mutex lock;
+    size_t jobs = 0, failures = 0, inputBytes = 0, outputBytes = 0;
+};
+
+// Reader thread of one connection: parses the job lines, queues them and waits until all are answered
+void serveConnection(ServeConnection& connection, FairScheduler& scheduler, ThreadPool& pool, ServeTotals& totals) {
+    SocketLineReader reader(connection.fd);
+    std::string line;
+    size_t number = 0;
+    while (reader.next(line)) {
+        if (line.empty()) continue;
+        std::vector<std::string> fields;
+        std::stringstream split(line);
+        std::string field;
+        while (std::getline(split, field, '\t')) fields.push_back(field);
+        if (fields[0] == "stop") {
+            serveStopRequested = true;
+            connection.reply("{\"stopping\":true}");
+            continue;
+        }
+
+        std::shared_ptr<ServeJob> request(new ServeJob);
+        request->number = ++number;
+        request->received = std::chrono::steady_clock::now();
+        ConversionJob& job = request->job;
+        job.interactive = false;
+        job.mapped = true; // pool-only paths, as in batch mode
+        job.digestKind = digestKind;
+        if (fields[0] != "convert" || fields.size() < 3 || fields[1].empty() || fields[2].empty()) {
+            job.error = "Expected convert<TAB><input><TAB><output>";
+        } else {
+            request->inputName = job.inputPath = fields[1];
+            job.outputPath = fields[2];
+        }
+        for (size_t i = 3; i < fields.size() && job.error.empty(); ++i) {
+            if (fields[i].compare(0, 7, "digest=") != 0 || !parseDigestKind(fields[i].substr(7), job.digestKind)) {
+                job.error = "Unknown job option: " + fields[i];
+            }
+        }
+        if (job.error.empty() && isStdioPath(job.inputPath)) {
+            struct stat info;
+            request->inputFd = reader.takeFd();
+            if (request->inputFd < 0) {
+                job.error = "Input - needs a file descriptor sent along with the job!";
+            } else if (fstat(request->inputFd, &info) != 0 || !S_ISREG(info.st_mode)) {
+                job.error = "Input descriptor must be a regular file, not a pipe or terminal!";
+            } else {
+                job.inputPath = "/dev/fd/" + std::to_string(request->inputFd);
+            }
+        } else if (job.error.empty() && (!std::filesystem::path(job.inputPath).is_absolute() ||
+                                         !std::filesystem::path(job.outputPath).is_absolute())) {
+            job.error = "Paths must be absolute, the daemon does not share the client's working directory!";
+        }
+        if (!job.error.empty()) {
+            if (request->inputFd >= 0) close(request->inputFd);
+            connection.reply(serveReport(*request));
+            continue;
+        }
+
+        {
+            std::lock_guard<std::mutex> guard(connection.lock);
+            connection.pending++;
+        }
+        scheduler.add(connection.id, [request, &connection, &pool, &totals] {
+            ConversionJob& job = request->job;
+            request->queuedSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - request->received).count();
+            if (abortRequested) {
+                job.error = "Skipped after Tab + ESC";
+            } else if (!std::filesystem::exists(job.inputPath)) {
+                job.error = std::string(encodeMode ? "Input" : "Hex") + " file not found!";
+            } else {
+                convertFile(job, pool);
+            }
+            if (request->inputFd >= 0) close(request->inputFd);
+            {
+                std::lock_guard<std::mutex> guard(totals.lock);
+                totals.jobs++;
+                totals.failures += job.ok ? 0 : 1;
+                totals.inputBytes += job.inputBytes;
+                totals.outputBytes += job.outputBytes;
+                if (job.ok) {
+                    std::cout << "[OK] client " << connection.id << " job " << request->number << ": " << request->inputName << " -> "
+                              << job.outputPath << ": " << formatSize(job.outputBytes) << " in " << std::fixed << std::setprecision(3)
+                              << job.seconds << "s" << std::endl;
+                } else {
+                    std::cout << "[FAILED] client " << connection.id << " job " << request->number << ": " << request->inputName
+                              << ": " << (job.error.empty() ? "Stopped by user" : job.error) << std::endl;
+                }
+            }
+            connection.reply(serveReport(*request));
+            std::lock_guard<std::mutex> guard(connection.lock);
+            if (--connection.pending == 0) connection.idle.notify_all();
+        });
+    }
+
+    std::unique_lock<std::mutex> guard(connection.lock);
+    connection.idle.wait(guard, [&] { return connection.pending == 0; });
+    close(connection.fd);
+    connection.finished = true;
+}
+
+// --serve: one warm pool for every job of every client until "stop", SIGINT/SIGTERM or Tab + ESC
+bool runServer(const std::string& socketPath) {
+    sockaddr_un address;
+    if (!unixSocketAddress(socketPath, address)) {
+        std::cerr << "[ERROR]: Socket path is empty or too long! (" << socketPath << ")" << std::endl;
+        return false;
+    }
+    int listenFd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listenFd < 0) {
+        std::cerr << "[ERROR]: Unable to create a Unix domain socket!" << std::endl;
+        return false;
+    }
+    // A socket file nobody answers on is left over from a daemon that did not exit cleanly
+    if (connect(listenFd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == 0) {
+        std::cerr << "[ERROR]: Another daemon is already serving on " << socketPath << "!" << std::endl;
+        close(listenFd);
+        return false;
+    }
+    close(listenFd);
+    struct stat info;
+    if (lstat(socketPath.c_str(), &info) == 0 && S_ISSOCK(info.st_mode)) unlink(socketPath.c_str());
+    listenFd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listenFd < 0 || bind(listenFd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 ||
+        chmod(socketPath.c_str(), 0600) != 0 || listen(listenFd, 64) != 0) {
+        std::cerr << "[ERROR]: Unable to listen on " << socketPath << "! (" << std::strerror(errno) << ")" << std::endl;
+        if (listenFd >= 0) close(listenFd);
+        return false;
+    }
+
+    unsigned int numCores = std::thread::hardware_concurrency();
+    if (numCores < 1) numCores = 2;
+    ThreadPool pool(requestedThreads > 0 ? requestedThreads : numCores);
+    FairScheduler scheduler(pool);
+    ServeTotals totals;
+
+    std::cout << "Serving conversions on " << socketPath << " with " << pool.size() << " worker threads ("
+              << decodeKernel.name << " kernel)." << std::endl;
+    std::cout << "Press Tab + ESC or send stop to exit.\n" << std::endl;
+    checkTabEscExit(); // sets up the terminal, and its own signal handlers, before ours replace them
+    std::signal(SIGINT, requestServeStop);
+    std::signal(SIGTERM, requestServeStop);
+    std::signal(SIGPIPE, SIG_IGN); // a client that hung up must not take the daemon with it
+
+    std::vector<std::unique_ptr<ServeConnection>> connections;
+    uint64_t nextId = 0;
+    while (!serveStopRequested) {
+        if (checkTabEscExit()) {
+            abortRequested = true;
+            serveStopRequested = true;
+            std::cout << "\nExiting daemon as requested by user (Tab + ESC).\n" << std::endl;
+            break;
+        }
+        // Reap the connections that are done, so threads do not pile up on a long-running daemon
+        for (size_t i = 0; i < connections.size();) {
+            if (connections[i]->finished) {
+                connections[i]->reader.join();
+                connections.erase(connections.begin() + static_cast<std::ptrdiff_t>(i));
+            } else {
+                ++i;
+            }
+        }
+        pollfd incoming = { listenFd, POLLIN, 0 };
+        if (poll(&incoming, 1, 200) <= 0 || !(incoming.revents & POLLIN)) continue;
+        int fd = accept(listenFd, nullptr, nullptr);
+        if (fd < 0) continue;
+        fcntl(fd, F_SETFD, FD_CLOEXEC);
+        connections.emplace_back(new ServeConnection);
+        ServeConnection& connection = *connections.back();
+        connection.fd = fd;
+        connection.id = ++nextId;
+        debugPrint("Client " + std::to_string(connection.id) + " connected");
+        connection.reader = std::thread(serveConnection, std::ref(connection), std::ref(scheduler), std::ref(pool), std::ref(totals));
+    }
+
+    // No new jobs from here on; the queued ones still run and are answered
+    close(listenFd);
+    unlink(socketPath.c_str());
+    for (auto& connection : connections) shutdown(connection->fd, SHUT_RD);
+    for (auto& connection : connections) connection->reader.join();
+    scheduler.drain();
+    std::cout << "Daemon stopped: " << totals.jobs << " jobs served" << (totals.failures ? ", " + std::to_string(totals.failures) + " failed" : std::string())
+              << ", " << formatSize(totals.inputBytes) << " in, " << formatSize(totals.outputBytes) << " out." << std::endl;
+    return true;
+}
+
+// --client: sends the -i/-o pairs (or a --batch manifest) to a daemon and prints its answers like a batch run
+bool runClient(const std::string& socketPath, const std::vector<std::pair<std::string, std::string>>& conversions, bool stop) {
+    sockaddr_un address;
+    int fd = unixSocketAddress(socketPath, address) ? socket(AF_UNIX, SOCK_STREAM, 0) : -1;
+    if (fd < 0 || connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+        std::cerr << "[ERROR]: No daemon is serving on " << socketPath << "! Start one with --serve=<socket>" << std::endl;
+        if (fd >= 0) close(fd);
+        return false;
+    }
+    std::signal(SIGPIPE, SIG_IGN);
+
+    bool sent = true;
+    for (const auto& conversion : conversions) {
+        std::string input = isStdioPath(conversion.first) ? conversion.first : getAbsolutePath(conversion.first);
+        std::string line = "convert\t" + input + "\t" + getAbsolutePath(conversion.second);
+        if (digestKind != DigestKind::None) line += std::string("\tdigest=") + digestName(digestKind);
+        sent = sent && sendAll(fd, line + "\n", isStdioPath(conversion.first) ? STDIN_FILENO : -1);
+    }
+    if (stop) sent = sent && sendAll(fd, "stop\n");
+    shutdown(fd, SHUT_WR);
+
+    SocketLineReader reader(fd);
+    std::string line;
+    size_t answered = 0, failures = 0;
+    while (reader.next(line)) {
+        debugPrint("Daemon: " + line);
+        if (jsonField(line, "stopping") == "true") {
+            std::cout << "Daemon is stopping." << std::endl;
+            continue;
+        }
+        size_t number = static_cast<size_t>(std::strtoull(jsonField(line, "job").c_str(), nullptr, 10));
+        if (number < 1 || number > conversions.size()) continue;
+        const auto& conversion = conversions[number - 1];
+        answered++;
+        if (jsonField(line, "ok") == "true") {
+            std::cout << "[OK] " << conversion.first << " -> " << conversion.second << ": "
+                      << formatSize(static_cast<size_t>(std::strtoull(jsonField(line, "outputBytes").c_str(), nullptr, 10)))
+                      << " in " << std::fixed << std::setprecision(3) << std::strtod(jsonField(line, "seconds").c_str(), nullptr)
+                      << "s (queued " << std::strtod(jsonField(line, "queuedSeconds").c_str(), nullptr) << "s)" << std::endl;
+            std::string digest = jsonField(line, "digest");
+            if (!digest.empty()) std::cout << "     Digest (" << jsonField(line, "digestAlgorithm") << "): " << digest << std::endl;
+        } else {
+            failures++;
+            std::cout << "[FAILED] " << conversion.first << ": " << jsonField(line, "error") << std::endl;
+        }
+    }
+    close(fd);
+    if (!sent || answered < conversions.size()) {
+        std::cerr << "[ERROR]: The daemon closed the connection before answering every job!" << std::endl;
+        return false;
+    }
+    return failures == 0;
+}
+#endif
+
+// Benchmark suite (--bench): decode kernels on an in-memory buffer, then every corpus file
+// through both I/O modes at each thread count. Results are JSON Lines, one object per measurement.
+struct BenchOptions {
+    std::vector<size_t> sizes = { 1024, 1024 * 1024, 64 * 1024 * 1024 }; // decoded bytes per corpus file
+    std::string corpusDir;  // generated files are kept here and reused by later runs
+    std::string outputPath; // JSON Lines destination, stdout when empty
+};
+BenchOptions benchOptions;
+
+// "64M" -> 67108864; K, M and G are binary multiples
+bool parseByteSize(const std::string& text, size_t& bytes) {
+    size_t digits = text.find_first_not_of("0123456789");
+    if (digits == 0 || text.size() > 12) return false;
+    bytes = std::stoull(text.substr(0, digits));
+    std::string suffix = digits == std::string::npos ? "" : text.substr(digits);
+    if (suffix == "k" || suffix == "K") bytes <<= 10;
+    else if (suffix == "m" || suffix == "M") bytes <<= 20;
+    else if (suffix == "g" || suffix == "G") bytes <<= 30;
+    else if (!suffix.empty()) return false;
+    return bytes > 0;
+}
+
+std::string byteSizeLabel(size_t bytes) {
+    if (bytes % (1ull << 30) == 0) return std::to_string(bytes >> 30) + "G";
+    if (bytes % (1 << 20) == 0) return std::to_string(bytes >> 20) + "M";
+    if (bytes % (1 << 10) == 0) return std::to_string(bytes >> 10) + "K";
+    return std::to_string(bytes);
+}
+
+// Time stamp counter ticks, or 0 where there is none; cycles/byte is then reported as null
+uint64_t cycleCounter() {
+#ifdef HEX2FILE_X86
+    return __rdtsc();
+#else
+    return 0;
+#endif
+}
+
+// Start a new peak-RSS window where the OS allows it (Linux clear_refs)
+void resetPeakRss() {
+#ifdef __linux__
+    std::ofstream("/proc/self/clear_refs") << "5";
+#endif
+}
+
+size_t peakRssBytes() {
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS counters;
+    if (K32GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) return counters.PeakWorkingSetSize;
+    return 0;
+#else
+#ifdef __linux__
+    std::ifstream status("/proc/self/status");
+    std::string line;
+    while (std::getline(status, line)) {
+        if (line.compare(0, 6, "VmHWM:") == 0) return static_cast<size_t>(std::stoull(line.substr(6))) * 1024;
+    }
+#endif
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0) return 0;
+#ifdef __APPLE__
+    return static_cast<size_t>(usage.ru_maxrss);
+#else
+    return static_cast<size_t>(usage.ru_maxrss) * 1024;
+#endif
+#endif
+}
+
+// Layouts the corpus covers; every style decodes to the same bytes for a given size
+struct CorpusStyle {
+    const char* name;
+    EncodeFormat format;
+    bool crlf;
+};
+const CorpusStyle CORPUS_STYLES[] = {
+    { "dense",     { true,  false, 32 }, false },
+    { "spaced",    { true,  true,  16 }, false },
+    { "crlf",      { true,  true,  16 }, true },
+    { "lowercase", { false, false, 32 }, false },
+    { "longline",  { true,  false, 0 },  false }, // the whole file on a single line
+};
+
+// xorshift64 with a fixed seed, so the corpus is identical on every machine
+void fillCorpusBytes(uint64_t& state, unsigned char* out, size_t n) {
+    for (size_t i = 0; i < n; ++i) {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        out[i] = static_cast<unsigned char>(state >> 32);
+    }
+}
+
+bool writeCorpusFile(const std::string& path, const CorpusStyle& style, size_t bytes) {
+    std::string partial = path + ".partial";
+    std::ofstream output(partial, std::ios::binary);
+    if (!output.is_open()) return false;
+
+    uint64_t state = 0x9E3779B97F4A7C15ull;
+    std::vector<unsigned char> raw(ENCODE_BLOCK);
+    std::vector<char> text(encodedLength(style.format, 0, ENCODE_BLOCK, false) + 2), crlf;
+    for (size_t first = 0; first < bytes; first += ENCODE_BLOCK) {
+        size_t n = std::min(ENCODE_BLOCK, bytes - first);
+        fillCorpusBytes(state, raw.data(), n);
+        size_t length = encodeRange(style.format, raw.data(), first, n, first + n == bytes, text.data());
+        if (style.crlf) {
+            crlf.clear();
+            for (size_t i = 0; i < length; ++i) {
+                if (text[i] == '\n') crlf.push_back('\r');
+                crlf.push_back(text[i]);
+            }
+            output.write(crlf.data(), static_cast<std::streamsize>(crlf.size()));
+        } else {
+            output.write(text.data(), static_cast<std::streamsize>(length));
+        }
+    }
+    output.close();
+    if (!output) return false;
+    std::error_code ec;
+    std::filesystem::rename(partial, path, ec);
+    return !ec;
+}
+
+// Emits one JSON object per line and mirrors a short summary on stderr
+class BenchReport {
+public:
+    explicit BenchReport(std::ostream& out) : out(out) {}
+
+    void record(const std::string& fields) { out << "{" << fields << "}" << std::endl; }
+
+    // Common fields of a timed run over 'bytes' decoded bytes
+    static std::string timing(size_t bytes, double seconds, uint64_t cycles, size_t runs, size_t peakRss) {
+        std::ostringstream fields;
+        fields << std::setprecision(6) << "\"bytes\":" << bytes << ",\"runs\":" << runs << ",\"seconds\":" << seconds
+               << ",\"gbps\":" << (seconds > 0 ? bytes / seconds / 1e9 : 0.0) << ",\"cyclesPerByte\":";
+        if (cycles > 0 && bytes > 0) fields << static_cast<double>(cycles) / bytes;
+        else fields << "null";
+        fields << ",\"peakRssBytes\":" << peakRss;
+        return fields.str();
+    }
+
+private:
+    std::ostream& out;
+};
+
+// 'bytes' random bytes and their dense hex on a single line, for timing the decode kernels alone
+void makeKernelCorpus(size_t bytes, std::vector<unsigned char>& raw, std::vector<char>& hex) {
+    raw.resize(bytes);
+    uint64_t state = 0x9E3779B97F4A7C15ull;
+    fillCorpusBytes(state, raw.data(), bytes);
+    hex.resize(2 * bytes);
+    EncodeFormat dense;
+    dense.spaced = false;
+    encodeRange(dense, raw.data(), 0, bytes, true, hex.data());
+}
+
+// Runs 'fn' at least once and until about half a second has passed (at most ten runs), keeping the fastest
+template <typename Fn>
+void timeBest(Fn fn, double& bestSeconds, uint64_t& bestCycles, size_t& runs) {
+    bestSeconds = 0.0;
+    bestCycles = 0;
+    runs = 0;
+    double total = 0.0;
+    while (runs < 1 || (runs < 10 && total < 0.5)) {
+        uint64_t cyclesBefore = cycleCounter();
+        auto start = std::chrono::steady_clock::now();
+        if (!fn()) return;
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        uint64_t cycles = cycleCounter() - cyclesBefore;
+        if (runs == 0 || seconds < bestSeconds) {
+            bestSeconds = seconds;
+            bestCycles = cycles;
+        }
+        total += seconds;
+        runs++;
+    }
+}
+
+bool runBenchmarks() {
+    std::ofstream file;
+    if (!benchOptions.outputPath.empty()) {
+        file.open(benchOptions.outputPath);
+        if (!file.is_open()) {
+            std::cerr << "[ERROR]: Unable to open benchmark output file! (" << benchOptions.outputPath << ")" << std::endl;
+            return false;
+        }
+    }
+    BenchReport report(benchOptions.outputPath.empty() ? std::cout : file);
+
+    std::string corpusDir = benchOptions.corpusDir;
+    if (corpusDir.empty()) corpusDir = (std::filesystem::temp_directory_path() / "hex2file_corpus").string();
+    std::error_code ec;
+    std::filesystem::create_directories(corpusDir, ec);
+    if (ec) {
+        std::cerr << "[ERROR]: Unable to create corpus directory! (" << corpusDir << ")" << std::endl;
+        return false;
+    }
+
+    unsigned int numCores = std::thread::hardware_concurrency();
+    if (numCores < 1) numCores = 2;
+    std::vector<unsigned int> threadCounts;
+    if (requestedThreads > 0) {
+        threadCounts.push_back(requestedThreads);
+    } else {
+        for (unsigned int t = 1; t < numCores; t *= 2) threadCounts.push_back(t);
+        threadCounts.push_back(numCores);
+    }
+
+    std::vector<DecodeKernel> kernels = availableDecodeKernels();
+    std::string kernelNames;
+    for (const DecodeKernel& kernel : kernels) kernelNames += (kernelNames.empty() ? "" : ",") + jsonString(kernel.name);
+    report.record("\"bench\":\"machine\",\"version\":\"1.0\",\"cores\":" + std::to_string(numCores)
+                  + ",\"decodeKernels\":[" + kernelNames + "],\"cycleCounter\":" + (cycleCounter() ? "\"tsc\"" : "null"));
+
+    // Decode kernels alone, on one dense line larger than typical last-level caches
+    {
+        const size_t bytes = 16 * 1024 * 1024;
+        std::vector<unsigned char> raw;
+        std::vector<char> hex, out(bytes);
+        makeKernelCorpus(bytes, raw, hex);
+        for (const DecodeKernel& kernel : kernels) {
+            double seconds;
+            uint64_t cycles;
+            size_t runs;
+            resetPeakRss();
+            timeBest([&] { return kernel.decode(hex.data(), bytes, out.data()) == bytes; }, seconds, cycles, runs);
+            bool ok = runs > 0 && std::memcmp(out.data(), raw.data(), bytes) == 0;
+            report.record("\"bench\":\"kernel\",\"kernel\":" + jsonString(kernel.name) + ",\"ok\":" + (ok ? "true," : "false,")
+                          + BenchReport::timing(bytes, seconds, cycles, runs, peakRssBytes()));
+            std::cerr << "[BENCH]: kernel " << kernel.name << ": " << std::fixed << std::setprecision(2)
+                      << (seconds > 0 ? bytes / seconds / 1e9 : 0.0) << " GB/s" << std::endl;
+        }
+    }
+
+    // Corpus: every style at every size, plus the example files when run from the repository
+    std::vector<std::pair<std::string, std::string>> corpus; // name, path
+    for (size_t bytes : benchOptions.sizes) {
+        for (const CorpusStyle& style : CORPUS_STYLES) {
+            std::string name = std::string(style.name) + "-" + byteSizeLabel(bytes);
+            std::string path = (std::filesystem::path(corpusDir) / (name + ".hex")).string();
+            if (!std::filesystem::exists(path)) {
+                std::cerr << "[BENCH]: generating " << path << std::endl;
+                if (!writeCorpusFile(path, style, bytes)) {
+                    std::cerr << "[ERROR]: Unable to write corpus file! (" << path << ")" << std::endl;
+                    return false;
+                }
+            }
+            corpus.push_back({ name, path });
+        }
+    }
+    if (std::filesystem::is_directory("example", ec)) {
+        std::vector<std::string> examples;
+        for (const auto& entry : std::filesystem::directory_iterator("example", ec)) {
+            if (entry.path().extension() == ".hex") examples.push_back(entry.path().string());
+        }
+        std::sort(examples.begin(), examples.end());
+        for (const std::string& path : examples) corpus.push_back({ std::filesystem::path(path).filename().string(), path });
+    }
+
+    // I/O modes: the streamed pipeline on each file backend, then the memory-mapped converter
+    struct IoMode {
+        const char* name;
+        bool mapped;
+        IoBackend backend;
+    };
+    std::vector<IoMode> ioModes = { { "stream", false, IoBackend::Stream } };
+#ifndef _WIN32
+    ioModes.push_back({ "posix", false, IoBackend::Posix });
+    ioModes.push_back({ "uring", false, IoBackend::Uring });
+#endif
+    ioModes.push_back({ "mmap", true, IoBackend::Stream });
+
+    std::string scratch = (std::filesystem::path(corpusDir) / "bench-output.bin").string();
+    for (unsigned int threads : threadCounts) {
+        ThreadPool pool(threads);
+        for (const auto& file : corpus) {
+            for (const IoMode& mode : ioModes) {
+                bool mapped = mode.mapped;
+                ioBackend = mode.backend;
+                if (checkTabEscExit()) {
+                    std::cerr << "\nExiting benchmark as requested by user (Tab + ESC).\n" << std::endl;
+                    std::filesystem::remove(scratch, ec);
+                    return false;
+                }
+                ConversionJob job;
+                double seconds;
+                uint64_t cycles;
+                size_t runs;
+                resetPeakRss();
+                timeBest([&] {
+                    job = ConversionJob();
+                    job.inputPath = file.second;
+                    job.outputPath = scratch;
+                    job.interactive = false;
+                    job.mapped = mapped;
+                    return convertFile(job, pool);
+                }, seconds, cycles, runs);
+
+                std::string fields = "\"bench\":\"convert\",\"corpus\":" + jsonString(file.first) + ",\"io\":"
+                                     + jsonString(mode.name) + ",\"threads\":" + std::to_string(threads)
+                                     + ",\"inputBytes\":" + std::to_string(job.inputBytes) + ",\"ok\":" + (job.ok ? "true" : "false");
+                if (!job.ok) fields += ",\"error\":" + jsonString(job.error);
+                report.record(fields + "," + BenchReport::timing(job.outputBytes, seconds, cycles, runs, peakRssBytes()));
+                std::cerr << "[BENCH]: " << file.first << " " << mode.name << " " << threads << " threads: ";
+                if (job.ok) std::cerr << std::fixed << std::setprecision(2) << (seconds > 0 ? job.outputBytes / seconds / 1e9 : 0.0) << " GB/s" << std::endl;
+                else std::cerr << "failed (" << job.error << ")" << std::endl;
+            }
+        }
+    }
+    std::filesystem::remove(scratch, ec);
+    return true;
+}
+
+// Round-trip self-check (--selfTest): decode(encode(x)) == x for every encode and decode kernel this CPU runs,
+// in every --encode layout. Kernels are checked on buffers of sizes around their vector widths, then whole
+// files go through the streamed and --mmap converters with chunks small enough that their edges are crossed,
+// and a file with runs of zeros through --sparse on each I/O backend.
+bool runSelfTest() {
+    std::vector<EncodeKernel> encoders = availableEncodeKernels();
+    std::vector<DecodeKernel> decoders = availableDecodeKernels();
+    std::vector<EncodeFormat> formats;
+    for (bool spaced : { true, false }) {
+        for (bool uppercase : { true, false }) {
+            for (size_t lineBytes : { 0, 1, 7, 16 }) formats.push_back({ uppercase, spaced, lineBytes });
+        }
+    }
+    auto formatName = [](const EncodeFormat& format) {
+        return std::string(format.spaced ? "spaced" : "dense") + (format.uppercase ? "" : " lowercase") + " lineBytes="
+               + std::to_string(format.lineBytes);
+    };
+
+    size_t checks = 0, failures = 0;
+    auto check = [&](bool ok, const std::string& what) {
+        checks++;
+        if (ok) return;
+        failures++;
+        std::cerr << "[SELFTEST]: FAILED " << what << std::endl;
+    };
+
+    EncodeKernel savedEncoder = encodeKernel;
+    DecodeKernel savedDecoder = decodeKernel;
+    EncodeFormat savedFormat = encodeFormat;
+    InputFormat savedInputFormat = inputFormat;
+    size_t savedChunk = chunkSizeHex;
+
+    // Kernels alone. Encoding is split in two at an arbitrary byte, as the pipeline's blocks may be.
+    const size_t sizes[] = { 0, 1, 15, 16, 17, 31, 32, 33, 47, 48, 49, 63, 64, 65, 127, 128, 129, 1000, 4099 };
+    std::vector<unsigned char> raw(4099);
+    uint64_t state = 0x9E3779B97F4A7C15ull;
+    fillCorpusBytes(state, raw.data(), raw.size());
+    for (const EncodeFormat& format : formats) {
+        for (size_t n : sizes) {
+            std::string label = formatName(format) + " " + std::to_string(n) + " bytes";
+            size_t length = encodedLength(format, 0, n, true);
+            std::vector<char> expected(length + 1), text(length + 1), out(n);
+            encodeKernel = encoders.front();
+            check(encodeRange(format, raw.data(), 0, n, true, expected.data()) == length, "encoded length, " + label);
+            for (const EncodeKernel& encoder : encoders) {
+                encodeKernel = encoder;
+                size_t cut = n / 3;
+                size_t written = encodeRange(format, raw.data(), 0, cut, false, text.data());
+                written += encodeRange(format, raw.data() + cut, cut, n - cut, true, text.data() + written);
+                check(written == length && std::memcmp(text.data(), expected.data(), length) == 0,
+                      std::string("encode kernel ") + encoder.name + ", " + label);
+            }
+            std::string digits;
+            for (size_t i = 0; i < length; ++i) {
+                if (expected[i] != ' ' && expected[i] != '\n') digits += expected[i];
+            }
+            for (const DecodeKernel& decoder : decoders) {
+                bool ok = digits.size() == 2 * n && decoder.decode(digits.data(), n, out.data()) == n
+                          && std::memcmp(out.data(), raw.data(), n) == 0;
+                check(ok, std::string("decode kernel ") + decoder.name + ", " + label);
+            }
+        }
+    }
+
+    // Whole files through the converters
+    std::error_code ec;
+    std::filesystem::path dir = std::filesystem::temp_directory_path() / "hex2file_selftest";
+    std::filesystem::create_directories(dir, ec);
+    std::string rawPath = (dir / "input.bin").string(), hexPath = (dir / "encoded.hex").string();
+    std::string outPath = (dir / "decoded.bin").string();
+    std::string rawBytes(100003, '\0'); // no multiple of any block, vector or line size
+    state = 0x9E3779B97F4A7C15ull;
+    fillCorpusBytes(state, reinterpret_cast<unsigned char*>(&rawBytes[0]), rawBytes.size());
+    auto writeFile = [](const std::string& path, const std::string& data) {
+        std::ofstream output(path, std::ios::binary | std::ios::trunc);
+        output.write(data.data(), static_cast<std::streamsize>(data.size()));
+        return static_cast<bool>(output.flush());
+    };
+    auto readFile = [](const std::string& path) {
+        std::ifstream input(path, std::ios::binary);
+        std::stringstream contents;
+        contents << input.rdbuf();
+        return contents.str();
+    };
+
+    unsigned int numCores = std::thread::hardware_concurrency();
+    ThreadPool pool(requestedThreads > 0 ? requestedThreads : std::max(2u, numCores));
+    auto convert = [&](const std::string& input, const std::string& output, bool mapped, bool encode) {
+        encodeMode = encode;
+        ConversionJob job;
+        job.inputPath = input;
+        job.outputPath = output;
+        job.interactive = false;
+        job.mapped = mapped;
+        convertFile(job, pool);
+        encodeMode = false;
+        return job;
+    };
+
+    chunkSizeHex = 16 * 1024;
+    inputFormat = InputFormat::Hex;
+    // The odd size, then an exact multiple of the chunk size: a stream only learns that such an input
+    // ended from an empty last chunk
+    for (size_t size : { rawBytes.size(), static_cast<size_t>(6 * 16 * 1024) }) {
+        std::string input = rawBytes.substr(0, size);
+        if (!writeFile(rawPath, input)) {
+            std::cerr << "[ERROR]: Unable to write self-test file! (" << rawPath << ")" << std::endl;
+            return false;
+        }
+        for (const EncodeFormat& format : formats) {
+            encodeFormat = format;
+            std::string expected(encodedLength(format, 0, size, true) + 1, '\0');
+            encodeKernel = encoders.front();
+            expected.resize(encodeRange(format, reinterpret_cast<const unsigned char*>(input.data()), 0, size, true, &expected[0]));
+            for (bool mapped : { false, true }) {
+                std::string label = formatName(format) + ", " + std::to_string(size) + " bytes" + (mapped ? ", --mmap" : ", streamed");
+                for (const EncodeKernel& encoder : encoders) {
+                    encodeKernel = encoder;
+                    ConversionJob job = convert(rawPath, hexPath, mapped, true);
+                    check(job.ok && readFile(hexPath) == expected, std::string("encode ") + encoder.name + ", " + label
+                          + (job.error.empty() ? "" : " (" + job.error + ")"));
+                }
+                // Decoders read the reference text, so a broken encoder is not blamed on them
+                writeFile(hexPath, expected);
+                for (const DecodeKernel& decoder : decoders) {
+                    decodeKernel = decoder;
+                    ConversionJob job = convert(hexPath, outPath, mapped, false);
+                    check(job.ok && readFile(outPath) == input, std::string("decode ") + decoder.name + ", " + label
+                          + (job.error.empty() ? "" : " (" + job.error + ")"));
+                }
+            }
+        }
+    }
+
+#ifndef _WIN32
+    // --sparse on every I/O backend, with and without --direct: 20K zero runs make holes that end at
+    // unaligned chunk edges, so writing resumes past the end of the file
+    {
+        std::string sparseBytes = rawBytes;
+        for (size_t i = 6000; i < sparseBytes.size(); i += 26000) {
+            std::fill_n(sparseBytes.begin() + i, std::min<size_t>(20 * 1024, sparseBytes.size() - i), '\0');
+        }
+        EncodeFormat dense;
+        dense.spaced = false;
+        std::string text(2 * sparseBytes.size(), '\0');
+        encodeKernel = encoders.front();
+        encodeRange(dense, reinterpret_cast<const unsigned char*>(sparseBytes.data()), 0, sparseBytes.size(), true, &text[0]);
+        writeFile(hexPath, text);
+        IoBackend savedBackend = ioBackend;
+        bool savedDirect = directIo, savedSparse = sparseOutput;
+        decodeKernel = decoders.back();
+        sparseOutput = true;
+        for (IoBackend backend : { IoBackend::Stream, IoBackend::Posix, IoBackend::Uring }) {
+            for (bool direct : { false, true }) {
+                if (direct && backend == IoBackend::Stream) continue;
+                ioBackend = backend;
+                directIo = direct;
+                ConversionJob job = convert(hexPath, outPath, false, false);
+                std::string label = std::string("--sparse --io=") + (backend == IoBackend::Stream ? "stream" : backend == IoBackend::Posix ? "posix" : "uring")
+                                    + (direct ? " --direct" : "");
+                check(job.ok && readFile(outPath) == sparseBytes, label + (job.error.empty() ? "" : " (" + job.error + ")"));
+            }
+        }
+        ioBackend = savedBackend;
+        directIo = savedDirect;
+        sparseOutput = savedSparse;
+    }
+#endif
+
+    encodeKernel = savedEncoder;
+    decodeKernel = savedDecoder;
+    encodeFormat = savedFormat;
+    inputFormat = savedInputFormat;
+    chunkSizeHex = savedChunk;
+    std::filesystem::remove_all(dir, ec);
+
+    std::string encoderNames, decoderNames;
+    for (const EncodeKernel& encoder : encoders) encoderNames += (encoderNames.empty() ? "" : ", ") + std::string(encoder.name);
+    for (const DecodeKernel& decoder : decoders) decoderNames += (decoderNames.empty() ? "" : ", ") + std::string(decoder.name);
+    std::cout << "Encode kernels: " << encoderNames << "\nDecode kernels: " << decoderNames << "\n";
+    if (failures > 0) {
+        std::cerr << "[ERROR]: Self-test failed " << failures << " of " << checks << " checks!" << std::endl;
+        return false;
+    }
+    std::cout << "Self-test passed: " << checks << " checks." << std::endl;
+    return true;
+}
+
+// Machine profile written by --tune and loaded by later runs: decode kernel, worker threads and chunk size.
+// It records the machine it was measured on and is ignored on any other (e.g. a home directory shared by hosts).
+struct TuningProfile {
+    std::string kernel;
+    unsigned int threads = 0;
+    size_t chunkBytes = 0;
+};
+std::string profilePath; // --profile, empty = defaultProfilePath()
+bool tuneMode = false;
+
+// %LOCALAPPDATA%\Hex2File\profile.txt, or $XDG_CONFIG_HOME/hex2file/profile (~/.config by default)
+std::string defaultProfilePath() {
+#ifdef _WIN32
+    const char* base = std::getenv("LOCALAPPDATA");
+    return base ? (std::filesystem::path(base) / "Hex2File" / "profile.txt").string() : "";
+#else
+    const char* config = std::getenv("XDG_CONFIG_HOME");
+    const char* home = std::getenv("HOME");
+    if (config && *config) return (std::filesystem::path(config) / "hex2file" / "profile").string();
+    return home ? (std::filesystem::path(home) / ".config" / "hex2file" / "profile").string() : "";
+#endif
+}
+
+// What a profile is only valid for: the core count and the decode kernels this CPU offers
+std::string machineIdentity() {
+    std::string kernels;
+    for (const DecodeKernel& kernel : availableDecodeKernels()) kernels += (kernels.empty() ? "" : ",") + std::string(kernel.name);
+    return "cores=" + std::to_string(std::max(1u, std::thread::hardware_concurrency())) + " kernels=" + kernels;
+}
+
+// False when there is no profile for this machine at 'path'; 'error' is only set for a damaged file
+bool loadProfile(const std::string& path, TuningProfile& profile, std::string& error) {
+    std::ifstream file(path);
+    if (!file.is_open()) return false;
+    std::string line, machine;
+    while (std::getline(file, line)) {
+        std::istringstream fields(line);
+        std::string key;
+        fields >> key;
+        if (key == "machine") std::getline(fields >> std::ws, machine);
+        else if (key == "kernel") fields >> profile.kernel;
+        else if (key == "threads") fields >> profile.threads;
+        else if (key == "chunk-size") fields >> profile.chunkBytes;
+        if (!key.empty() && !fields && !fields.eof()) {
+            error = "Tuning profile is damaged! (" + path + ")";
+            return false;
+        }
+    }
+    if (machine != machineIdentity()) {
+        debugPrint("Ignoring tuning profile made on another machine (" + machine + "): " + path);
+        return false;
+    }
+    return true;
+}
+
+bool saveProfile(const std::string& path, const TuningProfile& profile) {
+    std::error_code ec;
+    std::filesystem::path parent = std::filesystem::path(path).parent_path();
+    if (!parent.empty()) std::filesystem::create_directories(parent, ec);
+    std::string partial = path + ".partial";
+    {
+        std::ofstream file(partial, std::ios::trunc);
+        file << "# Hex2File tuning profile, written by --tune\nmachine " << machineIdentity() << "\nkernel " << profile.kernel
+             << "\nthreads " << profile.threads << "\nchunk-size " << profile.chunkBytes << "\n";
+        if (!file.flush()) return false;
+    }
+    std::filesystem::rename(partial, path, ec);
+    return !ec;
+}
+
+// Startup: the profile fills in whatever --threads and --chunkSize left open and picks the decode kernel
+bool applyProfile() {
+    std::string path = profilePath.empty() ? defaultProfilePath() : profilePath;
+    TuningProfile profile;
+    std::string error;
+    if (path.empty() || !loadProfile(path, profile, error)) {
+        if (!error.empty()) {
+            std::cerr << "[ERROR]: " << error << std::endl;
+            return false;
+        }
+        if (!profilePath.empty()) {
+            std::cerr << "[ERROR]: No tuning profile for this machine! Run --tune first. (" << profilePath << ")" << std::endl;
+            return false;
+        }
+        return true;
+    }
+    for (const DecodeKernel& kernel : availableDecodeKernels()) {
+        if (profile.kernel == kernel.name) decodeKernel = kernel;
+    }
+    if (requestedThreads == 0) requestedThreads = profile.threads;
+    if (chunkSizeHex == 0 && profile.chunkBytes % 2 == 0) chunkSizeHex = profile.chunkBytes;
+    debugPrint("Tuning profile " + path + ": kernel " + decodeKernel.name + ", " + std::to_string(profile.threads)
+               + " threads, " + formatSize(profile.chunkBytes) + " chunks");
+    return true;
+}
+
+// Settings within this fraction of the fastest count as tied; ties go to fewer threads and smaller chunks
+const double TUNE_TOLERANCE = 0.03;
+const size_t TUNE_CORPUS_BYTES = 32 * 1024 * 1024;
+
+// --tune: times the decode kernels, then short streamed conversions of a spaced corpus file at each
+// thread count and chunk size, one setting at a time, and writes the fastest combination to the profile
+bool runTune() {
+    std::string path = profilePath.empty() ? defaultProfilePath() : profilePath;
+    if (path.empty()) {
+        std::cerr << "[ERROR]: No place for the tuning profile, give one with --profile=<path>!" << std::endl;
+        return false;
+    }
+    std::string corpusDir = benchOptions.corpusDir;
+    if (corpusDir.empty()) corpusDir = (std::filesystem::temp_directory_path() / "hex2file_corpus").string();
+    std::error_code ec;
+    std::filesystem::create_directories(corpusDir, ec);
+    const CorpusStyle& style = CORPUS_STYLES[1];
+    std::string corpus = (std::filesystem::path(corpusDir) / (std::string(style.name) + "-" + byteSizeLabel(TUNE_CORPUS_BYTES) + ".hex")).string();
+    if (!std::filesystem::exists(corpus)) {
+        std::cerr << "[TUNE]: generating " << corpus << std::endl;
+        if (!writeCorpusFile(corpus, style, TUNE_CORPUS_BYTES)) {
+            std::cerr << "[ERROR]: Unable to write corpus file! (" << corpus << ")" << std::endl;
+            return false;
+        }
+    }
+
+    // Picks the fastest candidate, keeping the earliest (smallest) one among the ties
+    auto pickFastest = [](const std::vector<double>& seconds) {
+        size_t best = 0;
+        for (size_t i = 1; i < seconds.size(); ++i) {
+            if (seconds[i] < seconds[best]) best = i;
+        }
+        for (size_t i = 0; i < best; ++i) {
+            if (seconds[i] <= seconds[best] * (1.0 + TUNE_TOLERANCE)) return i;
+        }
+        return best;
+    };
+
+    // Kernels alone, single-threaded; on some CPUs the widest one is not the fastest
+    std::vector<DecodeKernel> kernels = availableDecodeKernels();
+    {
+        const size_t bytes = 16 * 1024 * 1024;
+        std::vector<unsigned char> raw;
+        std::vector<char> hex, out(bytes);
+        makeKernelCorpus(bytes, raw, hex);
+        std::vector<double> times;
+        for (const DecodeKernel& kernel : kernels) {
+            double seconds;
+            uint64_t cycles;
+            size_t runs;
+            timeBest([&] { return kernel.decode(hex.data(), bytes, out.data()) == bytes; }, seconds, cycles, runs);
+            if (runs == 0 || std::memcmp(out.data(), raw.data(), bytes) != 0) seconds = 1e30;
+            times.push_back(seconds);
+            std::cerr << "[TUNE]: kernel " << kernel.name << ": " << std::fixed << std::setprecision(2)
+                      << (seconds > 0 ? bytes / seconds / 1e9 : 0.0) << " GB/s" << std::endl;
+        }
+        // Ties go to the widest kernel here, the one bestDecodeKernel() would have picked anyway
+        std::reverse(kernels.begin(), kernels.end());
+        std::reverse(times.begin(), times.end());
+        decodeKernel = kernels[pickFastest(times)];
+    }
+
+    std::string scratch = (std::filesystem::path(corpusDir) / "tune-output.bin").string();
+    bool failed = false;
+    auto timeConversion = [&](unsigned int threads) {
+        ThreadPool pool(threads);
+        ConversionJob job;
+        double seconds;
+        uint64_t cycles;
+        size_t runs;
+        timeBest([&] {
+            job = ConversionJob();
+            job.inputPath = corpus;
+            job.outputPath = scratch;
+            job.interactive = false;
+            return convertFile(job, pool);
+        }, seconds, cycles, runs);
+        if (!job.ok) {
+            std::cerr << "[ERROR]: Calibration conversion failed! (" << job.error << ")" << std::endl;
+            failed = true;
+        }
+        return seconds;
+    };
+
+    // Worker threads at the usual chunk size, unless --threads fixed them
+    unsigned int numCores = std::max(1u, std::thread::hardware_concurrency());
+    std::vector<unsigned int> threadCounts;
+    if (requestedThreads > 0) {
+        threadCounts.push_back(requestedThreads);
+    } else {
+        for (unsigned int t = 1; t < numCores; t *= 2) threadCounts.push_back(t);
+        if (numCores > 2 && threadCounts.back() != numCores - 1) threadCounts.push_back(numCores - 1);
+        threadCounts.push_back(numCores);
+    }
+    size_t givenChunk = chunkSizeHex;
+    std::vector<double> times;
+    for (unsigned int threads : threadCounts) {
+        if (checkTabEscExit() || failed) break;
+        times.push_back(timeConversion(threads));
+        std::cerr << "[TUNE]: " << threads << " threads: " << std::fixed << std::setprecision(2)
+                  << TUNE_CORPUS_BYTES / times.back() / 1e9 << " GB/s" << std::endl;
+    }
+    if (failed || times.size() != threadCounts.size()) {
+        std::filesystem::remove(scratch, ec);
+        return false;
+    }
+    unsigned int threads = threadCounts[pickFastest(times)];
+
+    // Chunk sizes at that thread count, unless --chunkSize fixed it
+    std::vector<size_t> chunkSizes;
+    if (givenChunk > 0) {
+        chunkSizes.push_back(givenChunk);
+    } else {
+        for (size_t chunk = 256 * 1024; chunk <= ADAPTIVE_MAX_CHUNK; chunk *= 2) chunkSizes.push_back(chunk);
+    }
+    times.clear();
+    for (size_t chunk : chunkSizes) {
+        if (checkTabEscExit() || failed) break;
+        chunkSizeHex = chunk;
+        times.push_back(timeConversion(threads));
+        std::cerr << "[TUNE]: " << formatSize(chunk) << " chunks: " << std::fixed << std::setprecision(2)
+                  << TUNE_CORPUS_BYTES / times.back() / 1e9 << " GB/s" << std::endl;
+    }
+    std::filesystem::remove(scratch, ec);
+    if (failed || times.size() != chunkSizes.size()) return false;
+
+    TuningProfile profile;
+    profile.kernel = decodeKernel.name;
+    profile.threads = threads;
+    profile.chunkBytes = chunkSizes[pickFastest(times)];
+    if (!saveProfile(path, profile)) {
+        std::cerr << "[ERROR]: Unable to write tuning profile! (" << path << ")" << std::endl;
+        return false;
+    }
+    std::cout << "Tuned for this machine: kernel " << profile.kernel << ", " << profile.threads << " threads, "
+              << formatSize(profile.chunkBytes) << " chunks (" << std::fixed << std::setprecision(2)
+              << TUNE_CORPUS_BYTES / times[pickFastest(times)] / 1e9 << " GB/s)" << std::endl;
+    std::cout << "Profile written to " << path << std::endl;
+    return true;
+}
+
+int main(int argc, char* argv[]) {
+    std::map<std::string, std::string> args;
+
+    if (argc < 2) {
+        printIntroMessage();
+        return 0;
+    }
+
+    bool inputHexFlagFound = false;
+    bool outputFileFlagFound = false;
+    bool inputHexBeforeOutput = false;
+    std::vector<std::pair<std::string, std::string>> conversions;
+    std::string batchManifest;
+    bool ioBackendGiven = false;
+    std::string serveSocket, clientSocket;
+    bool stopServer = false;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        debugPrint("Parsing argument: " + arg);
+
+        std::string lowerArg = arg;
+        std::transform(lowerArg.begin(), lowerArg.end(), lowerArg.begin(), ::tolower);
+
+        if (lowerArg == "--help" || lowerArg == "-help" || lowerArg == "-h") {
+            printUsage();
+            return 0;
+        }
+        if (lowerArg == "--version" || lowerArg == "-version" || lowerArg == "-v") {
+            printVersion();
+            return 0;
+        }
+        if (lowerArg == "--debug" || lowerArg == "-debug" || lowerArg == "-d") {
+            debug = true;
+            debugPrint("Debug mode enabled.");
+        } 
+        else if (lowerArg == "--mmap" || lowerArg == "-mmap" || lowerArg == "-m") {
+            useMemoryMap = true;
+            debugPrint("Memory-mapped mode enabled.");
+        }
+        else if (lowerArg == "--encode" || lowerArg == "-encode" || lowerArg == "-e") {
+            encodeMode = true;
+            debugPrint("Encode mode enabled.");
+        }
+        else if (lowerArg.find("--inputformat=") == 0 || lowerArg.find("-inputformat=") == 0) {
+            std::string value = lowerArg.substr(lowerArg.find("=") + 1);
+            static const std::map<std::string, InputFormat> formats = {
+                { "auto", InputFormat::Auto }, { "hex", InputFormat::Hex }, { "ihex", InputFormat::IntelHex },
+                { "srec", InputFormat::SRecord }, { "xxd", InputFormat::Xxd }, { "carray", InputFormat::CArray }
+            };
+            auto it = formats.find(value);
+            if (it == formats.end()) {
+                std::cerr << "[ERROR]: Unknown input format: " << value << "\n";
+                std::cerr << "You must type --help to see all commands.\n";
+                return 1;
+            }
+            inputFormat = it->second;
+        }
+        else if (lowerArg.find("--fill=") == 0 || lowerArg.find("-fill=") == 0) {
+            std::string value = arg.substr(arg.find("=") + 1);
+            fillPattern.resize(value.size() / 2);
+            if (value.empty() || value.size() % 2 != 0 ||
+                decodeHexScalar(value.data(), fillPattern.size(), fillPattern.data()) != fillPattern.size()) {
+                std::cerr << "[ERROR]: Invalid fill pattern given for --fill! Use hex bytes such as --fill=FF\n";
+                std::cerr << "You must type --help to see all commands.\n";
+                return 1;
+            }
+        }
+        else if (lowerArg == "--format=spaced" || lowerArg == "-format=spaced") {
+            encodeFormat.spaced = true;
+        }
+        else if (lowerArg == "--format=dense" || lowerArg == "-format=dense") {
+            encodeFormat.spaced = false;
+        }
+        else if (lowerArg == "--lowercase" || lowerArg == "-lowercase") {
+            encodeFormat.uppercase = false;
+        }
+        else if (lowerArg.find("--linebytes=") == 0 || lowerArg.find("-linebytes=") == 0) {
+            std::string value = arg.substr(arg.find("=") + 1);
+            if (value.empty() || value.size() > 9 || value.find_first_not_of("0123456789") != std::string::npos) {
+                std::cerr << "[ERROR]: Invalid byte count given for --lineBytes!\n";
+                std::cerr << "You must type --help to see all commands.\n";
+                return 1;
+            }
+            encodeFormat.lineBytes = std::stoul(value);
+        }
+        else if (lowerArg == "--bench" || lowerArg == "-bench") {
+            benchMode = true;
+        }
+        else if (lowerArg == "--selftest" || lowerArg == "-selftest") {
+            selfTestMode = true;
+        }
+        else if (lowerArg.find("--benchsizes=") == 0 || lowerArg.find("-benchsizes=") == 0) {
+            std::string value = arg.substr(arg.find("=") + 1);
+            benchOptions.sizes.clear();
+            std::stringstream list(value);
+            std::string item;
+            while (std::getline(list, item, ',')) {
+                size_t bytes = 0;
+                if (!parseByteSize(item, bytes)) {
+                    std::cerr << "[ERROR]: Invalid size given for --benchSizes: " << item << " (use e.g. 1K,1M,2G)\n";
+                    std::cerr << "You must type --help to see all commands.\n";
+                    return 1;
+                }
+                benchOptions.sizes.push_back(bytes);
+            }
+        }
+        else if (lowerArg.find("--benchdir=") == 0 || lowerArg.find("-benchdir=") == 0) {
+            benchOptions.corpusDir = arg.substr(arg.find("=") + 1);
+        }
+        else if (lowerArg.find("--benchout=") == 0 || lowerArg.find("-benchout=") == 0) {
+            benchOptions.outputPath = arg.substr(arg.find("=") + 1);
+        }
+        else if (lowerArg == "--stats=json" || lowerArg == "-stats=json") {
+            statsFormat = StatsFormat::Json;
+        }
+        else if (lowerArg == "--stats=prometheus" || lowerArg == "-stats=prometheus") {
+            statsFormat = StatsFormat::Prometheus;
+        }
+        else if (lowerArg.find("--statsout=") == 0 || lowerArg.find("-statsout=") == 0) {
+            statsOutputPath = arg.substr(arg.find("=") + 1);
+        }
+        else if (lowerArg.find("--maxmemory=") == 0 || lowerArg.find("-maxmemory=") == 0) {
+            std::string value = arg.substr(arg.find("=") + 1);
+            if (!parseByteSize(value, memoryCap) || memoryCap < (1 << 20)) {
+                std::cerr << "[ERROR]: Invalid size given for --maxMemory! Use at least 1M, e.g. --maxMemory=64M\n";
+                std::cerr << "You must type --help to see all commands.\n";
+                return 1;
+            }
+        }
+        else if (lowerArg.find("--io=") == 0 || lowerArg.find("-io=") == 0) {
+            std::string value = lowerArg.substr(lowerArg.find("=") + 1);
+            if (value == "stream") {
+                ioBackend = IoBackend::Stream;
+            } else if (value == "posix") {
+                ioBackend = IoBackend::Posix;
+            } else if (value == "uring") {
+                ioBackend = IoBackend::Uring;
+            } else {
+                std::cerr << "[ERROR]: Invalid backend given for --io! Use stream, posix or uring\n";
+                std::cerr << "You must type --help to see all commands.\n";
+                return 1;
+            }
+            ioBackendGiven = true;
+        }
+        else if (lowerArg == "--direct" || lowerArg == "-direct") {
+            directIo = true;
+        }
+        else if (lowerArg == "--sparse" || lowerArg == "-sparse") {
+            sparseOutput = true;
+        }
+        else if (lowerArg == "--incremental" || lowerArg == "-incremental") {
+            useIncremental = true;
+        }
+        else if (lowerArg.find("--serve=") == 0 || lowerArg.find("-serve=") == 0) {
+            serveSocket = arg.substr(arg.find("=") + 1);
+        }
+        else if (lowerArg.find("--client=") == 0 || lowerArg.find("-client=") == 0) {
+            clientSocket = arg.substr(arg.find("=") + 1);
+        }
+        else if (lowerArg == "--stop" || lowerArg == "-stop") {
+            stopServer = true;
+        }
+        else if (lowerArg == "--tune" || lowerArg == "-tune") {
+            tuneMode = true;
+        }
+        else if (lowerArg.find("--profile=") == 0 || lowerArg.find("-profile=") == 0) {
+            profilePath = arg.substr(arg.find("=") + 1);
+        }
+        else if (lowerArg == "--adaptive" || lowerArg == "-adaptive") {
+            adaptiveChunks = true;
+        }
+        else if (lowerArg.find("--chunksize=") == 0 || lowerArg.find("-chunksize=") == 0) {
+            std::string value = arg.substr(arg.find("=") + 1);
+            if (!parseByteSize(value, chunkSizeHex) || chunkSizeHex < 4096 || chunkSizeHex > (1ull << 30) || chunkSizeHex % 2 != 0) {
+                std::cerr << "[ERROR]: Invalid size given for --chunkSize! Use an even size from 4K up, e.g. 1M\n";
+                std::cerr << "You must type --help to see all commands.\n";
+                return 1;
+            }
+        }
+        else if (lowerArg.find("--digest=") == 0 || lowerArg.find("-digest=") == 0) {
+            if (!parseDigestKind(lowerArg.substr(lowerArg.find("=") + 1), digestKind)) {
+                std::cerr << "[ERROR]: Invalid algorithm given for --digest! Use crc32c, xxh3 or sha256\n";
+                std::cerr << "You must type --help to see all commands.\n";
+                return 1;
+            }
+        }
+        else if (lowerArg.find("--expect=") == 0 || lowerArg.find("-expect=") == 0) {
+            expectedDigest = lowerArg.substr(lowerArg.find("=") + 1);
+            if (expectedDigest.compare(0, 2, "0x") == 0) expectedDigest.erase(0, 2);
+            if (expectedDigest.empty() || expectedDigest.find_first_not_of("0123456789abcdef") != std::string::npos) {
+                std::cerr << "[ERROR]: Invalid digest given for --expect! Use the hex value printed by --digest\n";
+                std::cerr << "You must type --help to see all commands.\n";
+                return 1;
+            }
+        }
+        else if (lowerArg == "--journal" || lowerArg == "-journal") {
+            useJournal = true;
+        }
+        else if (lowerArg == "--resume" || lowerArg == "-resume") {
+            useJournal = true;
+            resumeMode = true;
+        }
+        else if (lowerArg.find("--batch=") == 0 || lowerArg.find("-batch=") == 0 || lowerArg.find("-b=") == 0) {
+            batchManifest = arg.substr(arg.find("=") + 1);
+            if (batchManifest.empty()) {
+                std::cerr << "[ERROR]: Empty path given for --batch!\n";
+                std::cerr << "You must type --help to see all commands.\n";
+                return 1;
+            }
+        }
+        else if (lowerArg.find("--threads=") == 0 || lowerArg.find("-threads=") == 0 || lowerArg.find("-t=") == 0) {
+            std::string value = arg.substr(arg.find("=") + 1);
+            unsigned long count = 0;
+            try {
+                count = std::stoul(value);
+            } catch (const std::exception&) {
+                count = 0;
+            }
+            if (count < 1 || count > 1024 || value.find_first_not_of("0123456789") != std::string::npos) {
+                std::cerr << "[ERROR]: Invalid thread count given for --threads!\n";
+                std::cerr << "You must type --help to see all commands.\n";
+                return 1;
+            }
+            requestedThreads = static_cast<unsigned int>(count);
+            debugPrint("Worker threads requested: " + value);
+        }
+        else if (lowerArg == "--inputhex" || lowerArg == "-inputhex") {
+            std::cerr << "[ERROR]: Missing required path after --inputHex!\n";
+            std::cerr << "Use a required to type commands! --inputHex=<path> --outputFile=<path>\n\n";
+            std::cerr << "You must type --help to see all commands.\n";
+            return 1;
+        } 
+        else if (lowerArg == "--outputfile" || lowerArg == "-outputfile" || lowerArg == "-o" || lowerArg == "--outputfile=" || lowerArg == "-outputfile=" || lowerArg == "-o=") {
+            std::cerr << "[ERROR]: Invaild arguments way!\n";
+            std::cerr << "Use a required to type commands! --inputHex=<path> --outputFile=<path>\n\n";
+            std::cerr << "You must type --help to see all commands.\n";
+            return 1;
+        }
+        else if (lowerArg.find("--inputhex=") == 0 || lowerArg.find("-inputhex=") == 0 || lowerArg.find("-i=") == 0) {
+            std::string value = arg.substr(arg.find("=") + 1);
+            if (value.empty()) {
+                std::cerr << "[ERROR]: Empty path given for --inputHex!\n";
+                std::cerr << "Use a required to type commands! --inputHex=<path> --outputFile=<path>\n\n";
+                std::cerr << "You must type --help to see all commands.\n";
+                return 1;
+            }
+            // Each --inputHex needs its own --outputFile before the next one
+            auto pending = args.find("--inputHex");
+            if (pending != args.end()) {
+                std::cerr << "[ERROR]: Missing --outputFile for " << pending->second << "!\n";
+                std::cerr << "Use a required to type commands! --inputHex=<path> --outputFile=<path>\n\n";
+                std::cerr << "You must type --help to see all commands.\n";
+                return 1;
+            }
+            args["--inputHex"] = value;
+            inputHexFlagFound = true;
+            if (outputFileFlagFound) {
+                inputHexBeforeOutput = true;
+            }
+        } 
+        else if (lowerArg.find("--outputfile=") == 0 || lowerArg.find("-outputfile=") == 0 || lowerArg.find("-o=") == 0) {
+            std::string value = arg.substr(arg.find("=") + 1);
+            if (value.empty()) {
+                std::cerr << "[ERROR]: Empty path given for --outputFile!\n";
+                std::cerr << "Use a required to type commands! --inputHex=<path> --outputFile=<path>\n\n";
+                std::cerr << "You must type --help to see all commands.\n";
+                return 1;
+            }
+            args["--outputFile"] = value;
+            auto pending = args.find("--inputHex");
+            if (pending != args.end()) {
+                conversions.push_back({ pending->second, value });
+                args.erase(pending);
+            }
+            outputFileFlagFound = true;
+            if (inputHexFlagFound) {
+                inputHexBeforeOutput = false;
+            }
+        } 
+        else {
+            std::cerr << "[ERROR]: Unknown argument: " << arg << std::endl;
+            std::cerr << "You must type --help to see all commands.\n";
+            return 1;
+        }
+    }
+
+    if (!expectedDigest.empty()) {
+        const size_t digestLength = digestKind == DigestKind::Crc32c ? 8 : digestKind == DigestKind::Xxh3 ? 16 : 64;
+        if (digestKind == DigestKind::None) {
+            std::cerr << "[ERROR]: --expect needs --digest to say which algorithm the value belongs to!\n";
+        } else if (expectedDigest.size() != digestLength) {
+            std::cerr << "[ERROR]: A " << digestName(digestKind) << " digest has " << digestLength << " hex digits, --expect has "
+                      << expectedDigest.size() << "!\n";
+        }
+        if (digestKind == DigestKind::None || expectedDigest.size() != digestLength) {
+            std::cerr << "You must type --help to see all commands.\n";
+            return 1;
+        }
+    }
+
+    if (directIo && !ioBackendGiven) ioBackend = IoBackend::Uring;
+#ifdef _WIN32
+    if (ioBackend != IoBackend::Stream) {
+        std::cerr << "[ERROR]: --io=posix, --io=uring and --direct are only available on Linux and other POSIX systems!\n";
+        std::cerr << "You must type --help to see all commands.\n";
+        return 1;
+    }
+#endif
+    if (useIncremental && encodeMode) {
+        std::cerr << "[ERROR]: --incremental only applies to decoding!\n";
+        std::cerr << "You must type --help to see all commands.\n";
+        return 1;
+    }
+    if (sparseOutput && encodeMode) {
+        std::cerr << "[ERROR]: --sparse only applies to decoding, hex text never holds blocks of zeros!\n";
+        std::cerr << "You must type --help to see all commands.\n";
+        return 1;
+    }
+    if (directIo && ioBackend == IoBackend::Stream) {
+        std::cerr << "[ERROR]: --direct needs --io=posix or --io=uring!\n";
+        std::cerr << "You must type --help to see all commands.\n";
+        return 1;
+    }
+
+    if (benchMode) {
+        decodeKernel = availableDecodeKernels().back();
+        encodeKernel = availableEncodeKernels().back();
+        return runBenchmarks() ? 0 : 1;
+    }
+    if (tuneMode) {
+        decodeKernel = availableDecodeKernels().back();
+        return runTune() ? 0 : 1;
+    }
+    if (selfTestMode) return runSelfTest() ? 0 : 1;
+
+    if (!serveSocket.empty() || !clientSocket.empty()) {
+#ifdef _WIN32
+        std::cerr << "[ERROR]: --serve and --client need Unix domain sockets and are only available on Linux and other POSIX systems!\n";
+        std::cerr << "You must type --help to see all commands.\n";
+        return 1;
+#else
+        if (!serveSocket.empty()) {
+            if (!clientSocket.empty() || inputHexFlagFound || outputFileFlagFound || !batchManifest.empty()) {
+                std::cerr << "[ERROR]: --serve takes its jobs from clients, not from --inputHex, --outputFile, --batch or --client!\n";
+            } else if (useJournal || ioBackend != IoBackend::Stream || !expectedDigest.empty()) {
+                std::cerr << "[ERROR]: --journal, --io, --direct and --expect do not apply to --serve!\n";
+            } else {
+                decodeKernel = availableDecodeKernels().back();
+                encodeKernel = availableEncodeKernels().back();
+                if (!applyProfile()) return 1;
+                return runServer(serveSocket) ? 0 : 1;
+            }
+            std::cerr << "You must type --help to see all commands.\n";
+            return 1;
+        }
+        if (!batchManifest.empty()) {
+            std::string error;
+            if (!readManifest(batchManifest, conversions, error)) {
+                std::cerr << "[ERROR]: " << error << std::endl;
+                return 1;
+            }
+        }
+        bool writesStdout = false;
+        for (const auto& conversion : conversions) writesStdout = writesStdout || isStdioPath(conversion.second);
+        if ((conversions.empty() && !stopServer) || args.count("--inputHex")) {
+            std::cerr << "[ERROR]: --client needs --inputHex/--outputFile pairs, a --batch manifest or --stop!\n";
+        } else if (writesStdout) {
+            std::cerr << "[ERROR]: The daemon writes the output files itself, --client cannot write to standard output (-)!\n";
+        } else {
+            return runClient(clientSocket, conversions, stopServer) ? 0 : 1;
+        }
+        std::cerr << "You must type --help to see all commands.\n";
+        return 1;
+#endif
+    }
+
+    // "-" streams through stdin/stdout and journals need seekable files: one conversion, no memory maps
+    auto checkConversions = [&]() {
+        bool usesStdio = false;
+        for (const auto& conversion : conversions) {
+            usesStdio = usesStdio || isStdioPath(conversion.first) || isStdioPath(conversion.second);
+        }
+        if (useJournal && (conversions.size() > 1 || useMemoryMap || usesStdio)) {
+            std::cerr << "[ERROR]: --journal and --resume need a single streamed conversion between real files (no --mmap, batch or -)!\n";
+            std::cerr << "You must type --help to see all commands.\n";
+            return false;
+        }
+        if (ioBackend != IoBackend::Stream && (conversions.size() > 1 || useMemoryMap)) {
+            std::cerr << "[ERROR]: --io and --direct apply to a single streamed conversion (no --mmap or batch)!\n";
+            std::cerr << "You must type --help to see all commands.\n";
+            return false;
+        }
+        bool writesStdout = false;
+        for (const auto& conversion : conversions) writesStdout = writesStdout || isStdioPath(conversion.second);
+        if (useIncremental && (usesStdio || useMemoryMap || useJournal || ioBackend != IoBackend::Stream || sparseOutput || !expectedDigest.empty())) {
+            std::cerr << "[ERROR]: --incremental patches real output files with its own converter (no -, --mmap, --journal, --io, --sparse or --expect)!\n";
+            std::cerr << "You must type --help to see all commands.\n";
+            return false;
+        }
+        if (sparseOutput && writesStdout) {
+            std::cerr << "[ERROR]: --sparse needs a seekable output file, it cannot write to standard output (-)!\n";
+            std::cerr << "You must type --help to see all commands.\n";
+            return false;
+        }
+        if (!expectedDigest.empty() && conversions.size() > 1) {
+            std::cerr << "[ERROR]: --expect checks a single conversion and cannot be used in batch mode!\n";
+            std::cerr << "You must type --help to see all commands.\n";
+            return false;
+        }
+        if (!usesStdio) return true;
+        if (conversions.size() > 1) {
+            std::cerr << "[ERROR]: Standard input/output (-) can only be used for a single conversion!\n";
+        } else if (useMemoryMap) {
+            std::cerr << "[ERROR]: --mmap needs real files and cannot be used with standard input/output (-)!\n";
+        } else if (isStdioPath(conversions[0].first) && inputFormat != InputFormat::Auto && inputFormat != InputFormat::Hex) {
+            std::cerr << "[ERROR]: Record formats need a real input file and cannot be read from standard input (-)!\n";
+        } else {
+            return true;
+        }
+        std::cerr << "You must type --help to see all commands.\n";
+        return false;
+    };
+
+    if (!batchManifest.empty()) {
+        if (inputHexFlagFound || outputFileFlagFound) {
+            std::cerr << "[ERROR]: --batch cannot be combined with --inputHex or --outputFile!\n";
+            std::cerr << "You must type --help to see all commands.\n";
+            return 1;
+        }
+        std::string error;
+        if (!readManifest(batchManifest, conversions, error)) {
+            std::cerr << "[ERROR]: " << error << std::endl;
+            return 1;
+        }
+        if (conversions.empty()) {
+            std::cerr << "[ERROR]: Batch manifest lists no files! (" << batchManifest << ")" << std::endl;
+            return 1;
+        }
+        if (!checkConversions()) return 1;
+        decodeKernel = availableDecodeKernels().back();
+        encodeKernel = availableEncodeKernels().back();
+        if (!applyProfile()) return 1;
+        return processBatch(conversions) ? 0 : 1;
+    }
+
+    // New backwards argument order error
+    if (!args.count("--inputHex") && !args.count("--outputFile") &&
+        inputHexFlagFound && outputFileFlagFound && inputHexBeforeOutput) {
+        std::cerr << "[ERROR]: Invaild way arguments! \n";
+        std::cerr << "Use a required to type commands! --inputHex=<path> --outputFile=<path>\n\n";
+        std::cerr << "You must type --help to see all commands.\n";
+        return 1;
+    }
+
+    // Handling missing arguments and flags
+    if (!inputHexFlagFound || !outputFileFlagFound || (args.count("--inputHex") && !conversions.empty())) {
+        std::cerr << "[ERROR]: Missing required arguments!\n";
+        std::cerr << "Use a required to type commands! --inputHex=<path> --outputFile=<path>\n\n";
+        std::cerr << "You must type --help to see all commands.\n";
+        return 1;
+    }
+
+    // Debugging path arguments
+    for (const auto& conversion : conversions) {
+        debugPrint("Input Path: " + conversion.first);
+        debugPrint("Output Path: " + conversion.second);
+    }
+
+    // Extra debugging for the order of the flags
+    if (inputHexFlagFound && outputFileFlagFound) {
+        if (inputHexBeforeOutput) {
+            debugPrint("--inputHex flag found before --outputFile flag.");
+        } else {
+            debugPrint("--outputFile flag found before --inputHex flag.");
+        }
+    }
+
+    // Check for invalid argument order (reversed flags with values)
+    if (inputHexFlagFound && outputFileFlagFound && inputHexBeforeOutput) {
         std::cerr << "[ERROR]: Invalid argument ways!\nUse a required to type commands! --inputHex=<path> --outputFile=<path>\n\n";
         std::cerr << "You must type --help to see all commands.\n";
         return 1;
     }
 
-    return processFile(args["--inputHex"], args["--outputFile"]) ? 0 : 1;
+    decodeKernel = availableDecodeKernels().back();
+    encodeKernel = availableEncodeKernels().back();
+    if (!applyProfile()) return 1;
+
+    if (!checkConversions()) return 1;
+    if (conversions.size() > 1) return processBatch(conversions) ? 0 : 1;
+
+#ifdef _WIN32
+    if (isStdioPath(conversions[0].first)) _setmode(_fileno(stdin), _O_BINARY);
+    if (isStdioPath(conversions[0].second)) _setmode(_fileno(stdout), _O_BINARY);
+#else
+    // Keystrokes would be read out of the hex data
+    if (isStdioPath(conversions[0].first)) keyboardPolling = false;
+#endif
+    // Standard output carries the data, so every message goes to stderr instead
+    std::streambuf* consoleBuffer = std::cout.rdbuf();
+    if (isStdioPath(conversions[0].second)) std::cout.rdbuf(std::cerr.rdbuf());
+    bool converted = processFile(conversions[0].first, conversions[0].second);
+    std::cout.rdbuf(consoleBuffer);
+    return converted ? 0 : 1;
 }
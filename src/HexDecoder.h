@@ -0,0 +1,362 @@
+/*
+This repository is licensed under the GNU General Public License.
+Free to use, modify, or create your own fork, provided that you agree to and comply with the terms of the license.
+
+(C) 2025 - svh03ra, all rights reserved.
+*/
+
+// Hex2File decoding as a header-only library: the lookup tables, the SIMD decode kernels and an incremental
+// HexDecoder for programs that want to convert hex text in-process. No console I/O, no threads, no globals.
+// The Hex2File command line tool is built on top of it.
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define HEX2FILE_X86 1
+#include <immintrin.h>
+#endif
+
+namespace hex2file {
+
+inline bool isHexChar(char c) {
+    return (c >= '0' && c <= '9') || (c >= 'A' && c <= 'F') || (c >= 'a' && c <= 'f');
+}
+
+inline bool isSpaceChar(char c) {
+    return c == ' ' || (c >= '\t' && c <= '\r');
+}
+
+// Hex digit value for every possible byte, 0xFF for anything that is not a hex digit
+struct HexTable {
+    unsigned char value[256];
+    constexpr HexTable() : value() {
+        for (int i = 0; i < 256; ++i) value[i] = 0xFF;
+        for (int i = 0; i < 10; ++i) value['0' + i] = static_cast<unsigned char>(i);
+        for (int i = 0; i < 6; ++i) {
+            value['A' + i] = static_cast<unsigned char>(10 + i);
+            value['a' + i] = static_cast<unsigned char>(10 + i);
+        }
+    }
+};
+inline constexpr HexTable HEX_TABLE;
+
+// Decode kernels turn 2 * numBytes hex characters into numBytes bytes.
+// They return how many bytes were decoded before the first invalid character (numBytes on success).
+inline size_t decodeHexScalar(const char* hex, size_t numBytes, char* out) {
+    for (size_t i = 0; i < numBytes; ++i) {
+        unsigned char hi = HEX_TABLE.value[static_cast<unsigned char>(hex[2 * i])];
+        unsigned char lo = HEX_TABLE.value[static_cast<unsigned char>(hex[2 * i + 1])];
+        if ((hi | lo) & 0xF0) return i;
+        out[i] = static_cast<char>((hi << 4) | lo);
+    }
+    return numBytes;
+}
+
+#ifdef HEX2FILE_X86
+// Turn 16 ASCII characters into nibble values; 'valid' gets all-ones lanes where the character was a hex digit
+__attribute__((target("sse2"), always_inline))
+inline __m128i hexNibblesSSE2(__m128i c, __m128i& valid) {
+    __m128i digit = _mm_sub_epi8(c, _mm_set1_epi8('0'));
+    __m128i alpha = _mm_sub_epi8(_mm_or_si128(c, _mm_set1_epi8(0x20)), _mm_set1_epi8('a'));
+    __m128i digitOk = _mm_cmpeq_epi8(_mm_min_epu8(digit, _mm_set1_epi8(9)), digit);
+    __m128i alphaOk = _mm_cmpeq_epi8(_mm_min_epu8(alpha, _mm_set1_epi8(5)), alpha);
+    valid = _mm_or_si128(digitOk, alphaOk);
+    return _mm_or_si128(_mm_and_si128(digitOk, digit),
+                        _mm_and_si128(alphaOk, _mm_add_epi8(alpha, _mm_set1_epi8(10))));
+}
+
+__attribute__((target("sse2")))
+inline size_t decodeHexSSE2(const char* hex, size_t numBytes, char* out) {
+    size_t i = 0;
+    for (; i + 8 <= numBytes; i += 8) { // 16 hex chars -> 8 bytes
+        __m128i valid;
+        __m128i v = hexNibblesSSE2(_mm_loadu_si128(reinterpret_cast<const __m128i*>(hex + 2 * i)), valid);
+        if (_mm_movemask_epi8(valid) != 0xFFFF) break;
+        __m128i hi = _mm_slli_epi16(_mm_and_si128(v, _mm_set1_epi16(0x00FF)), 4);
+        __m128i lo = _mm_srli_epi16(v, 8);
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(out + i), _mm_packus_epi16(_mm_or_si128(hi, lo), _mm_setzero_si128()));
+    }
+    // Tail and the block holding a bad character (to find its exact position) go through the table
+    return i + decodeHexScalar(hex + 2 * i, numBytes - i, out + i);
+}
+
+__attribute__((target("ssse3")))
+inline size_t decodeHexSSSE3(const char* hex, size_t numBytes, char* out) {
+    size_t i = 0;
+    for (; i + 8 <= numBytes; i += 8) { // 16 hex chars -> 8 bytes
+        __m128i valid;
+        __m128i v = hexNibblesSSE2(_mm_loadu_si128(reinterpret_cast<const __m128i*>(hex + 2 * i)), valid);
+        if (_mm_movemask_epi8(valid) != 0xFFFF) break;
+        __m128i pairs = _mm_maddubs_epi16(v, _mm_set1_epi16(0x0110)); // hi * 16 + lo
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(out + i), _mm_packus_epi16(pairs, pairs));
+    }
+    return i + decodeHexScalar(hex + 2 * i, numBytes - i, out + i);
+}
+
+__attribute__((target("avx2")))
+inline size_t decodeHexAVX2(const char* hex, size_t numBytes, char* out) {
+    size_t i = 0;
+    for (; i + 16 <= numBytes; i += 16) { // 32 hex chars -> 16 bytes
+        __m256i c = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(hex + 2 * i));
+        __m256i digit = _mm256_sub_epi8(c, _mm256_set1_epi8('0'));
+        __m256i alpha = _mm256_sub_epi8(_mm256_or_si256(c, _mm256_set1_epi8(0x20)), _mm256_set1_epi8('a'));
+        __m256i digitOk = _mm256_cmpeq_epi8(_mm256_min_epu8(digit, _mm256_set1_epi8(9)), digit);
+        __m256i alphaOk = _mm256_cmpeq_epi8(_mm256_min_epu8(alpha, _mm256_set1_epi8(5)), alpha);
+        if (_mm256_movemask_epi8(_mm256_or_si256(digitOk, alphaOk)) != -1) break;
+        __m256i v = _mm256_blendv_epi8(digit, _mm256_add_epi8(alpha, _mm256_set1_epi8(10)), alphaOk);
+        __m256i pairs = _mm256_maddubs_epi16(v, _mm256_set1_epi16(0x0110));
+        __m256i packed = _mm256_permute4x64_epi64(_mm256_packus_epi16(pairs, pairs), 0x08);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), _mm256_castsi256_si128(packed));
+    }
+    return i + decodeHexScalar(hex + 2 * i, numBytes - i, out + i);
+}
+
+__attribute__((target("avx512bw")))
+inline size_t decodeHexAVX512(const char* hex, size_t numBytes, char* out) {
+    size_t i = 0;
+    for (; i + 32 <= numBytes; i += 32) { // 64 hex chars -> 32 bytes
+        __m512i c = _mm512_loadu_si512(hex + 2 * i);
+        __m512i digit = _mm512_sub_epi8(c, _mm512_set1_epi8('0'));
+        __m512i alpha = _mm512_sub_epi8(_mm512_or_si512(c, _mm512_set1_epi8(0x20)), _mm512_set1_epi8('a'));
+        __mmask64 digitOk = _mm512_cmple_epu8_mask(digit, _mm512_set1_epi8(9));
+        __mmask64 alphaOk = _mm512_cmple_epu8_mask(alpha, _mm512_set1_epi8(5));
+        if ((digitOk | alphaOk) != ~0ULL) break;
+        __m512i v = _mm512_mask_blend_epi8(alphaOk, digit, _mm512_add_epi8(alpha, _mm512_set1_epi8(10)));
+        __m512i pairs = _mm512_maddubs_epi16(v, _mm512_set1_epi16(0x0110));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), _mm512_cvtepi16_epi8(pairs));
+    }
+    return i + decodeHexScalar(hex + 2 * i, numBytes - i, out + i);
+}
+#endif
+
+struct DecodeKernel {
+    const char* name;
+    size_t (*decode)(const char* hex, size_t numBytes, char* out);
+};
+
+// Every decode kernel this CPU can run, slowest first
+inline std::vector<DecodeKernel> availableDecodeKernels() {
+    std::vector<DecodeKernel> kernels = { { "scalar", decodeHexScalar } };
+#ifdef HEX2FILE_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("sse2")) kernels.push_back({ "sse2", decodeHexSSE2 });
+    if (__builtin_cpu_supports("ssse3")) kernels.push_back({ "ssse3", decodeHexSSSE3 });
+    if (__builtin_cpu_supports("avx2")) kernels.push_back({ "avx2", decodeHexAVX2 });
+    if (__builtin_cpu_supports("avx512bw")) kernels.push_back({ "avx512", decodeHexAVX512 });
+#endif
+    return kernels;
+}
+
+// Fastest kernel this CPU can run, looked up once
+inline const DecodeKernel& bestDecodeKernel() {
+    static const DecodeKernel best = availableDecodeKernels().back();
+    return best;
+}
+
+// Contiguous view of 'size' elements (std::span stand-in, the library builds as C++17)
+template <typename T>
+class Span {
+public:
+    constexpr Span() = default;
+    constexpr Span(T* data, size_t size) : ptr(data), length(size) {}
+    template <size_t N>
+    constexpr Span(T (&array)[N]) : ptr(array), length(N) {}
+    // Any container with data() and size(): std::vector, std::string, std::array, ...
+    template <typename Container,
+              typename = std::enable_if_t<std::is_convertible<decltype(std::declval<Container&>().data()), T*>::value>>
+    constexpr Span(Container&& container) : ptr(container.data()), length(container.size()) {}
+
+    constexpr T* data() const { return ptr; }
+    constexpr size_t size() const { return length; }
+    constexpr bool empty() const { return length == 0; }
+    constexpr T* begin() const { return ptr; }
+    constexpr T* end() const { return ptr + length; }
+    constexpr T& operator[](size_t i) const { return ptr[i]; }
+    constexpr Span first(size_t count) const { return Span(ptr, count); }
+    constexpr Span subspan(size_t offset) const { return Span(ptr + offset, length - offset); }
+
+private:
+    T* ptr = nullptr;
+    size_t length = 0;
+};
+
+enum class DecodeStatus { Ok, InvalidCharacter, OddDigitCount, OutputTooSmall };
+
+// What stopped a decode and where. 'offset' counts input characters from the start of the text
+// (the first feed() of a HexDecoder), whitespace included.
+struct DecodeError {
+    DecodeStatus status = DecodeStatus::Ok;
+    uint64_t offset = 0;  // the bad character, the unpaired last digit, or how far the input got before the output ran out
+    char character = 0;   // the bad character or the unpaired digit
+
+    explicit operator bool() const { return status != DecodeStatus::Ok; }
+
+    std::string message() const {
+        char text[96];
+        unsigned char c = static_cast<unsigned char>(character);
+        unsigned long long at = static_cast<unsigned long long>(offset);
+        switch (status) {
+            case DecodeStatus::InvalidCharacter:
+                if (c >= 0x20 && c < 0x7F) std::snprintf(text, sizeof(text), "invalid character '%c' at offset %llu", c, at);
+                else std::snprintf(text, sizeof(text), "invalid byte 0x%02X at offset %llu", c, at);
+                return text;
+            case DecodeStatus::OddDigitCount:
+                std::snprintf(text, sizeof(text), "unpaired hex digit '%c' at offset %llu", c, at);
+                return text;
+            case DecodeStatus::OutputTooSmall:
+                std::snprintf(text, sizeof(text), "output buffer too small at offset %llu", at);
+                return text;
+            default:
+                return "no error";
+        }
+    }
+};
+
+// Incremental hex decoder. Text can be fed in pieces of any size: whitespace is skipped anywhere and a
+// digit pair may straddle two calls. Decoding stops at the first invalid character; error() says where.
+//
+//     hex2file::HexDecoder decoder;
+//     while (size_t n = readSome(text, sizeof(text))) {
+//         auto bytes = decoder.feed({ text, n });
+//         consume(bytes.data(), bytes.size());
+//     }
+//     if (!decoder.finish()) report(decoder.error().message());
+class HexDecoder {
+public:
+    HexDecoder() : HexDecoder(bestDecodeKernel()) {}
+    explicit HexDecoder(DecodeKernel kernel) : kernel(kernel), scratch(PIECE + 1) {}
+
+    // Output bytes feed() may need for 'inputSize' characters of text
+    static constexpr size_t decodedCapacity(size_t inputSize) { return inputSize / 2 + 1; }
+
+    // Decodes 'input' into the caller's 'out', which must hold decodedCapacity(input.size()) bytes.
+    // Returns the bytes written: everything complete so far, or everything before the first bad character.
+    Span<char> feed(Span<const char> input, Span<char> out) {
+        if (failure) return Span<char>(out.data(), 0);
+        if (out.size() < decodedCapacity(input.size())) {
+            failure = { DecodeStatus::OutputTooSmall, consumed, 0 };
+            return Span<char>(out.data(), 0);
+        }
+        char* dest = out.data();
+        for (size_t at = 0; at < input.size(); at += PIECE) {
+            const char* raw = input.data() + at;
+            size_t rawLen = std::min(PIECE, input.size() - at);
+
+            // Dense text decodes straight from the input, anything else is compacted into the scratch piece first
+            size_t firstSpace = 0;
+            while (firstSpace < rawLen && !isSpaceChar(raw[firstSpace])) ++firstSpace;
+            bool carried = pending >= 0;
+            const char* hex = raw;
+            size_t hexLen = rawLen;
+            if (carried || firstSpace < rawLen) {
+                hexLen = 0;
+                if (carried) scratch[hexLen++] = static_cast<char>(pending);
+                for (size_t i = 0; i < rawLen; ++i) {
+                    if (!isSpaceChar(raw[i])) scratch[hexLen++] = raw[i];
+                }
+                hex = scratch.data();
+            }
+
+            size_t pairs = hexLen / 2;
+            size_t done = kernel.decode(hex, pairs, dest);
+            dest += done;
+            produced += done;
+            if (done != pairs) {
+                size_t bad = 2 * done + (HEX_TABLE.value[static_cast<unsigned char>(hex[2 * done])] == 0xFF ? 0 : 1);
+                failure = { DecodeStatus::InvalidCharacter, locate(raw, bad, carried), hex[bad] };
+                consumed += rawLen;
+                return Span<char>(out.data(), static_cast<size_t>(dest - out.data()));
+            }
+            if (hexLen % 2 != 0) {
+                if (!carried || hexLen > 1) {
+                    size_t last = rawLen;
+                    while (isSpaceChar(raw[--last])) {}
+                    pendingOffset = consumed + last;
+                }
+                pending = static_cast<unsigned char>(hex[hexLen - 1]);
+            } else {
+                pending = -1;
+            }
+            consumed += rawLen;
+        }
+        return Span<char>(out.data(), static_cast<size_t>(dest - out.data()));
+    }
+
+    // Same, into a buffer owned by the decoder that stays valid until the next call
+    Span<char> feed(Span<const char> input) {
+        if (buffer.size() < decodedCapacity(input.size())) buffer.resize(decodedCapacity(input.size()));
+        return feed(input, Span<char>(buffer));
+    }
+
+    // Call after the last feed(). False if decoding failed or the text ended on an unpaired digit.
+    bool finish() {
+        if (!failure && pending >= 0) {
+            char c = static_cast<char>(pending);
+            failure = { isHexChar(c) ? DecodeStatus::OddDigitCount : DecodeStatus::InvalidCharacter, pendingOffset, c };
+        }
+        return !failure;
+    }
+
+    // Ready for a new text, keeping the kernel and buffers
+    void reset() {
+        pending = -1;
+        pendingOffset = consumed = produced = 0;
+        failure = DecodeError();
+    }
+
+    const DecodeError& error() const { return failure; }
+    uint64_t inputOffset() const { return consumed; }   // text characters fed so far
+    uint64_t outputOffset() const { return produced; }  // bytes decoded so far
+    const char* kernelName() const { return kernel.name; }
+
+private:
+    static constexpr size_t PIECE = 64 * 1024; // text compacted at a time, small enough to stay in L2
+
+    DecodeKernel kernel;
+    std::vector<char> scratch, buffer;
+    int pending = -1;            // odd digit waiting for its partner from the next piece
+    uint64_t pendingOffset = 0;
+    uint64_t consumed = 0, produced = 0;
+    DecodeError failure;
+
+    // Text offset of digit 'index' of a compacted piece (whose digit 0 is the carried one when 'carried')
+    uint64_t locate(const char* raw, size_t index, bool carried) const {
+        if (carried) {
+            if (index == 0) return pendingOffset;
+            --index;
+        }
+        for (size_t i = 0;; ++i) {
+            if (isSpaceChar(raw[i])) continue;
+            if (index-- == 0) return consumed + i;
+        }
+    }
+};
+
+// One-shot decode of a whole text into the caller's 'out' (decodedCapacity(text.size()) bytes).
+// Returns the bytes written; 'error' is set if the text is not valid hex.
+inline Span<char> decode(Span<const char> text, Span<char> out, DecodeError& error) {
+    HexDecoder decoder;
+    Span<char> bytes = decoder.feed(text, out);
+    decoder.finish();
+    error = decoder.error();
+    return bytes;
+}
+
+// One-shot decode into a new vector; empty with 'error' set if the text is not valid hex
+inline std::vector<char> decode(Span<const char> text, DecodeError& error) {
+    std::vector<char> out(HexDecoder::decodedCapacity(text.size()));
+    out.resize(decode(text, Span<char>(out), error).size());
+    if (error) out.clear();
+    return out;
+}
+
+} // namespace hex2file